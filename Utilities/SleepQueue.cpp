@@ -3,41 +3,69 @@
 
 #include "SleepQueue.h"
 
-void sleep_queue_entry_t::add_entry()
+void sleep_queue_t::push(sleep_entry_t& entry)
 {
-	m_queue.emplace_back(std::static_pointer_cast<CPUThread>(m_thread.shared_from_this()));
-}
+	const auto node = &entry.sleep_node;
 
-void sleep_queue_entry_t::remove_entry()
-{
-	for (auto it = m_queue.begin(); it != m_queue.end(); it++)
+	if (node->queue)
 	{
-		if (it->get() == &m_thread)
-		{
-			m_queue.erase(it);
-			return;
-		}
+		throw EXCEPTION("Thread already added");
 	}
+
+	node->queue = this;
+	node->prio = m_priority ? entry.get_prio() : 0;
+
+	// find the last group with the same or higher priority
+	auto group = m_last_group;
+
+	while (group && group->prio > node->prio)
+	{
+		group = group->group_prev;
+	}
+
+	// insert after the last thread of this group (FIFO within the same priority)
+	const auto pos = group ? (group->group_next ? group->group_next->prev : m_tail) : nullptr;
+
+	if (!group || group->prio != node->prio)
+	{
+		// start a new group
+		node->group_head = true;
+		node->group_prev = group;
+		node->group_next = group ? group->group_next : m_first_group;
+		(node->group_next ? node->group_next->group_prev : m_last_group) = node;
+		(group ? group->group_next : m_first_group) = node;
+	}
+
+	node->prev = pos;
+	node->next = pos ? pos->next : m_head;
+	(node->next ? node->next->prev : m_tail) = node;
+	(pos ? pos->next : m_head) = node;
+
+	m_size++;
 }
 
-bool sleep_queue_entry_t::find() const
+bool sleep_queue_t::remove(sleep_entry_t& entry)
 {
-	for (auto it = m_queue.begin(); it != m_queue.end(); it++)
+	if (entry.sleep_node.queue != this)
 	{
-		if (it->get() == &m_thread)
-		{
-			return true;
-		}
+		return false;
 	}
 
-	return false;
+	unlink(&entry.sleep_node);
+
+	return true;
+}
+
+bool sleep_queue_t::contains(sleep_entry_t& entry) const
+{
+	return entry.sleep_node.queue == this;
 }
 
 sleep_queue_entry_t::sleep_queue_entry_t(sleep_entry_t& cpu, sleep_queue_t& queue)
 	: m_thread(cpu)
 	, m_queue(queue)
 {
-	add_entry();
+	m_queue.push(m_thread);
 	cpu.sleep();
 }
 
@@ -50,6 +78,6 @@ sleep_queue_entry_t::sleep_queue_entry_t(sleep_entry_t& cpu, sleep_queue_t& queu
 
 sleep_queue_entry_t::~sleep_queue_entry_t()
 {
-	remove_entry();
+	m_queue.remove(m_thread);
 	m_thread.awake();
 }
@@ -1,7 +1,212 @@
 #pragma once
 
 using sleep_entry_t = class CPUThread;
-using sleep_queue_t = std::deque<std::shared_ptr<sleep_entry_t>>;
+
+class sleep_queue_t;
+
+// sleep queue link embedded in the thread (a thread can be added to only one sleep queue at a time)
+struct sleep_queue_node_t final
+{
+	sleep_entry_t* thread; // owner (not changed)
+
+	sleep_queue_t* queue = nullptr; // queue containing the thread
+	sleep_queue_node_t* prev = nullptr;
+	sleep_queue_node_t* next = nullptr;
+	s32 prio = 0; // fixed at the moment of insertion
+
+	// links between the first threads of every priority (valid only if group_head is set)
+	sleep_queue_node_t* group_prev = nullptr;
+	sleep_queue_node_t* group_next = nullptr;
+	bool group_head = false;
+
+	explicit sleep_queue_node_t(sleep_entry_t* thread)
+		: thread(thread)
+	{
+	}
+
+	sleep_queue_node_t(const sleep_queue_node_t&) = delete;
+};
+
+// waiting threads in FIFO or priority order (intrusive list, entries aren't owned by the queue and aren't allocated)
+class sleep_queue_t final
+{
+	sleep_queue_node_t* m_head = nullptr;
+	sleep_queue_node_t* m_tail = nullptr;
+
+	// first threads of every priority present in the queue, in priority order (the last thread of the group precedes the next group)
+	sleep_queue_node_t* m_first_group = nullptr;
+	sleep_queue_node_t* m_last_group = nullptr;
+
+	std::size_t m_size = 0;
+
+	const bool m_priority;
+
+	void unlink(sleep_queue_node_t* node)
+	{
+		if (node->group_head)
+		{
+			// the next thread with the same priority becomes the first in the group, or the group is removed
+			const auto next = node->next && node->next->prio == node->prio ? node->next : nullptr;
+
+			if (next)
+			{
+				next->group_head = true;
+				next->group_prev = node->group_prev;
+				next->group_next = node->group_next;
+			}
+
+			(node->group_prev ? node->group_prev->group_next : m_first_group) = next ? next : node->group_next;
+			(node->group_next ? node->group_next->group_prev : m_last_group) = next ? next : node->group_prev;
+
+			node->group_head = false;
+			node->group_prev = nullptr;
+			node->group_next = nullptr;
+		}
+
+		(node->prev ? node->prev->next : m_head) = node->next;
+		(node->next ? node->next->prev : m_tail) = node->prev;
+
+		node->queue = nullptr;
+		node->prev = nullptr;
+		node->next = nullptr;
+
+		m_size--;
+	}
+
+public:
+	using value_type = sleep_entry_t*;
+
+	class iterator final
+	{
+		friend class sleep_queue_t;
+
+		sleep_queue_node_t* m_node;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = sleep_queue_t::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = value_type*;
+		using reference = value_type&;
+
+		iterator(sleep_queue_node_t* node)
+			: m_node(node)
+		{
+		}
+
+		reference operator *() const
+		{
+			return m_node->thread;
+		}
+
+		iterator& operator ++()
+		{
+			m_node = m_node->next;
+			return *this;
+		}
+
+		iterator operator ++(int)
+		{
+			const auto node = m_node;
+			m_node = m_node->next;
+			return node;
+		}
+
+		bool operator ==(const iterator& rhs) const
+		{
+			return m_node == rhs.m_node;
+		}
+
+		bool operator !=(const iterator& rhs) const
+		{
+			return m_node != rhs.m_node;
+		}
+	};
+
+	// threads with higher priority (lower value) are picked first if priority is set, FIFO otherwise
+	explicit sleep_queue_t(bool priority = false)
+		: m_priority(priority)
+	{
+	}
+
+	sleep_queue_t(const sleep_queue_t&) = delete;
+
+	~sleep_queue_t()
+	{
+		clear();
+	}
+
+	// add thread (O(1) in FIFO order, O(number of distinct priorities) in priority order)
+	void push(sleep_entry_t& entry);
+
+	// remove thread if added (O(1)), returns true if removed
+	bool remove(sleep_entry_t& entry);
+
+	// check whether the thread is added (O(1))
+	bool contains(sleep_entry_t& entry) const;
+
+	// thread to be picked first
+	value_type front() const
+	{
+		return m_head->thread;
+	}
+
+	void pop_front()
+	{
+		unlink(m_head);
+	}
+
+	iterator erase(iterator it)
+	{
+		const auto next = it.m_node->next;
+		unlink(it.m_node);
+		return next;
+	}
+
+	// remove threads for which the predicate returns true
+	template<typename F> void erase_if(F pred)
+	{
+		for (auto it = begin(); it != end();)
+		{
+			if (pred(*it))
+			{
+				it = erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void clear()
+	{
+		while (m_head)
+		{
+			unlink(m_head);
+		}
+	}
+
+	bool empty() const
+	{
+		return m_head == nullptr;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	iterator begin()
+	{
+		return m_head;
+	}
+
+	iterator end()
+	{
+		return nullptr;
+	}
+};
 
 static struct defer_sleep_t {} const defer_sleep{};
 
@@ -11,10 +216,6 @@ class sleep_queue_entry_t final
 	sleep_entry_t& m_thread;
 	sleep_queue_t& m_queue;
 
-	void add_entry();
-	void remove_entry();
-	bool find() const;
-
 public:
 	// add specified thread to the sleep queue
 	sleep_queue_entry_t(sleep_entry_t& entry, sleep_queue_t& queue);
@@ -28,18 +229,18 @@ public:
 	// add thread to the sleep queue
 	void enter()
 	{
-		add_entry();
+		m_queue.push(m_thread);
 	}
 
 	// remove thread from the sleep queue
 	void leave()
 	{
-		remove_entry();
+		m_queue.remove(m_thread);
 	}
 
 	// check whether the thread exists in the sleep queue
 	explicit operator bool() const
 	{
-		return find();
+		return m_queue.contains(m_thread);
 	}
 };
@@ -1153,6 +1153,12 @@ static LONG exception_handler(PEXCEPTION_POINTERS pExp)
 	const u64 addr64 = pExp->ExceptionRecord->ExceptionInformation[1] - (u64)vm::base(0);
 	const bool is_writing = pExp->ExceptionRecord->ExceptionInformation[0] != 0;
 
+	if (pExp->ExceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && addr64 < 0x100000000ull && is_writing && vm::code_write_notify((u32)addr64))
+	{
+		// Write to a watched code page (restart instruction)
+		return EXCEPTION_CONTINUE_EXECUTION;
+	}
+
 	if (pExp->ExceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && addr64 < 0x100000000ull && thread_ctrl::get_current() && handle_access_violation((u32)addr64, is_writing, pExp->ContextRecord))
 	{
 		return EXCEPTION_CONTINUE_EXECUTION;
@@ -1233,6 +1239,12 @@ static void signal_handler(int sig, siginfo_t* info, void* uct)
 	const u64 addr64 = (u64)info->si_addr - (u64)vm::base(0);
 	const auto cause = is_writing ? "writing" : "reading";
 
+	if (addr64 < 0x100000000ull && is_writing && vm::code_write_notify((u32)addr64))
+	{
+		// Write to a watched code page (restart instruction)
+		return;
+	}
+
 	if (addr64 < 0x100000000ull && thread_ctrl::get_current())
 	{
 		// Try to process access violation
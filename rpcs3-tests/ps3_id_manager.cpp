@@ -0,0 +1,232 @@
+#include "stdafx.h"
+
+#include "Emu/IdManager.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	const u32 g_objects = 1024; // IDs created for lookups
+	const u32 g_lookups = 1000000; // per thread
+
+	struct id_bench_object
+	{
+		const u32 id = idm::get_last_id();
+
+		u32 value = 1;
+	};
+
+	// Object with slow construction (creation shouldn't block lookups)
+	struct id_bench_slow_object
+	{
+		const u32 id = idm::get_last_id();
+
+		id_bench_slow_object()
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	};
+
+	struct fxm_bench_object
+	{
+		u32 value = 1;
+	};
+
+	// Run func(index) in the specified number of host threads, returns elapsed microseconds
+	template<typename F> u64 run_threads(u32 count, F func)
+	{
+		std::vector<std::thread> threads;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 i = 0; i < count; i++)
+		{
+			threads.emplace_back([&, i]()
+			{
+				func(i);
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::vector<u32> get_thread_counts()
+	{
+		std::vector<u32> result;
+
+		for (u32 count = 1; count <= std::max<u32>(std::thread::hardware_concurrency(), 4); count *= 2)
+		{
+			result.emplace_back(count);
+		}
+
+		return result;
+	}
+}
+
+TEST_CLASS(id_manager_test_class)
+{
+	// idm::get throughput for private (spread over all shards) and shared (single ID) lookups
+	TEST_METHOD(idm_get_scaling)
+	{
+		idm::clear();
+
+		std::vector<u32> ids;
+
+		for (u32 i = 0; i < g_objects; i++)
+		{
+			ids.emplace_back(idm::make<id_bench_object>());
+
+			Assert::AreEqual(ids.back(), idm::get<id_bench_object>(ids.back())->id);
+		}
+
+		for (const u32 count : get_thread_counts())
+		{
+			atomic_t<u32> failed{ 0 };
+
+			const u64 spread = run_threads(count, [&](u32 index)
+			{
+				u32 sum = 0;
+
+				for (u32 i = 0; i < g_lookups; i++)
+				{
+					if (const auto ptr = idm::get<id_bench_object>(ids[(i + index * 64) % g_objects]))
+					{
+						sum += ptr->value;
+					}
+				}
+
+				if (sum != g_lookups) failed++;
+			});
+
+			const u64 shared = run_threads(count, [&](u32 index)
+			{
+				u32 sum = 0;
+
+				for (u32 i = 0; i < g_lookups; i++)
+				{
+					if (const auto ptr = idm::get<id_bench_object>(ids[0]))
+					{
+						sum += ptr->value;
+					}
+				}
+
+				if (sum != g_lookups) failed++;
+			});
+
+			if (failed.load())
+			{
+				TEST_FAILURE("%u lookup threads failed (%u threads)", failed.load(), count);
+			}
+
+			TEST_LOG("idm::get, %u threads: %llu lookups/us (spread), %llu lookups/us (single ID)\n", count,
+				u64{ count } * g_lookups / std::max<u64>(spread, 1), u64{ count } * g_lookups / std::max<u64>(shared, 1));
+		}
+
+		idm::clear();
+	}
+
+	// idm::get throughput while other threads create and remove objects with slow constructors
+	TEST_METHOD(idm_get_during_creation)
+	{
+		idm::clear();
+
+		std::vector<u32> ids;
+
+		for (u32 i = 0; i < g_objects; i++)
+		{
+			ids.emplace_back(idm::make<id_bench_object>());
+		}
+
+		const u32 count = std::max<u32>(std::thread::hardware_concurrency(), 4);
+
+		atomic_t<u32> readers{ count / 2 };
+		atomic_t<u32> failed{ 0 };
+		atomic_t<u32> created{ 0 };
+
+		const u64 elapsed = run_threads(count, [&](u32 index)
+		{
+			if (index < count / 2)
+			{
+				u32 sum = 0;
+
+				for (u32 i = 0; i < g_lookups; i++)
+				{
+					if (const auto ptr = idm::get<id_bench_object>(ids[(i + index * 64) % g_objects]))
+					{
+						sum += ptr->value;
+					}
+				}
+
+				if (sum != g_lookups) failed++;
+
+				readers--;
+				return;
+			}
+
+			while (readers.load())
+			{
+				const auto ptr = idm::make_ptr<id_bench_slow_object>();
+
+				// the ID is visible only after the object is created
+				if (!ptr || idm::get<id_bench_slow_object>(ptr->id) != ptr || !idm::remove<id_bench_slow_object>(ptr->id))
+				{
+					failed++;
+					return;
+				}
+
+				created++;
+			}
+		});
+
+		if (failed.load())
+		{
+			TEST_FAILURE("%u threads failed", failed.load());
+		}
+
+		TEST_LOG("idm::get during creation, %u threads: %llu lookups/us, %u objects created\n", count,
+			u64{ count / 2 } * g_lookups / std::max<u64>(elapsed, 1), created.load());
+
+		idm::clear();
+	}
+
+	// fxm::get throughput (lock-free slot read)
+	TEST_METHOD(fxm_get_scaling)
+	{
+		fxm::make_always<fxm_bench_object>();
+
+		for (const u32 count : get_thread_counts())
+		{
+			atomic_t<u32> failed{ 0 };
+
+			const u64 elapsed = run_threads(count, [&](u32 index)
+			{
+				u32 sum = 0;
+
+				for (u32 i = 0; i < g_lookups; i++)
+				{
+					if (const auto ptr = fxm::get<fxm_bench_object>())
+					{
+						sum += ptr->value;
+					}
+				}
+
+				if (sum != g_lookups) failed++;
+			});
+
+			if (failed.load())
+			{
+				TEST_FAILURE("%u lookup threads failed (%u threads)", failed.load(), count);
+			}
+
+			TEST_LOG("fxm::get, %u threads: %llu lookups/us\n", count, u64{ count } * g_lookups / std::max<u64>(elapsed, 1));
+		}
+
+		fxm::remove<fxm_bench_object>();
+	}
+};
@@ -0,0 +1,498 @@
+#include "stdafx.h"
+
+#include "Emu/IdManager.h"
+#include "Emu/SysCalls/ErrorCodes.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/SysCalls/lv2/sys_sync.h"
+#include "Emu/SysCalls/lv2/sys_mutex.h"
+#include "Emu/SysCalls/lv2/sys_semaphore.h"
+#include "Emu/SysCalls/lv2/sys_lwmutex.h"
+#include "Emu/SysCalls/lv2/sys_event.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	const u32 g_private_iterations = 200000; // per thread, objects not shared between threads
+	const u32 g_shared_iterations = 20000; // per thread, single object shared by all threads
+
+	template<typename T> using page_var = vm::var<T, vm::page_alloc_t<>>;
+
+	u32 get_thread_count()
+	{
+		return std::max<u32>(std::thread::hardware_concurrency(), 4);
+	}
+
+	// Run func(index, ppu) in host threads (each with its own PPU thread context), returns elapsed microseconds
+	template<typename F> u64 run_ppu_threads(const char* name, u32 count, F func)
+	{
+		std::vector<std::shared_ptr<PPUThread>> ppus;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			ppus.emplace_back(idm::make_ptr<PPUThread>(fmt::format("Bench PPU %u", i)));
+		}
+
+		std::vector<std::thread> threads;
+
+		atomic_t<u32> failed{ 0 };
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 i = 0; i < count; i++)
+		{
+			threads.emplace_back([&, i]()
+			{
+				if (!func(i, *ppus[i]))
+				{
+					failed++;
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		const u64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		for (auto& ppu : ppus)
+		{
+			idm::remove<PPUThread>(ppu->get_id());
+		}
+
+		if (failed.load())
+		{
+			TEST_FAILURE("%s: %u threads failed", name, failed.load());
+		}
+
+		TEST_LOG("%s: %llu us (%u threads)\n", name, elapsed, count);
+
+		return elapsed;
+	}
+
+	u32 create_mutex()
+	{
+		page_var<u32> mutex_id;
+		page_var<sys_mutex_attribute_t> attr;
+
+		attr->protocol = SYS_SYNC_PRIORITY;
+		attr->recursive = SYS_SYNC_NOT_RECURSIVE;
+		attr->pshared = SYS_SYNC_NOT_PROCESS_SHARED;
+		attr->adaptive = SYS_SYNC_NOT_ADAPTIVE;
+		attr->ipc_key = 0;
+		attr->flags = 0;
+		attr->name_u64 = 0;
+
+		Assert::AreEqual<s32>(CELL_OK, sys_mutex_create(mutex_id, attr));
+
+		return *mutex_id;
+	}
+
+	u32 create_semaphore(s32 initial_val, s32 max_val)
+	{
+		page_var<u32> sem_id;
+		page_var<sys_semaphore_attribute_t> attr;
+
+		attr->protocol = SYS_SYNC_PRIORITY;
+		attr->pshared = SYS_SYNC_NOT_PROCESS_SHARED;
+		attr->ipc_key = 0;
+		attr->flags = 0;
+		attr->name_u64 = 0;
+
+		Assert::AreEqual<s32>(CELL_OK, sys_semaphore_create(sem_id, attr, initial_val, max_val));
+
+		return *sem_id;
+	}
+
+	u32 create_lwmutex()
+	{
+		page_var<u32> lwmutex_id;
+
+		Assert::AreEqual<s32>(CELL_OK, _sys_lwmutex_create(lwmutex_id, SYS_SYNC_PRIORITY, vm::null, 0x80000001, 0, 0));
+
+		return *lwmutex_id;
+	}
+
+	// Returns event queue id and connected event port id
+	std::pair<u32, u32> create_event_queue(s32 size)
+	{
+		page_var<u32> equeue_id;
+		page_var<u32> eport_id;
+		page_var<sys_event_queue_attribute_t> attr;
+
+		attr->protocol = SYS_SYNC_PRIORITY;
+		attr->type = SYS_PPU_QUEUE;
+		std::memset(attr->name, 0, sizeof(attr->name));
+
+		Assert::AreEqual<s32>(CELL_OK, sys_event_queue_create(equeue_id, attr, 0, size));
+		Assert::AreEqual<s32>(CELL_OK, sys_event_port_create(eport_id, SYS_EVENT_PORT_LOCAL, 0));
+		Assert::AreEqual<s32>(CELL_OK, sys_event_port_connect_local(*eport_id, *equeue_id));
+
+		return{ *equeue_id, *eport_id };
+	}
+}
+
+// Multi-threaded stress of lv2 synchronization syscalls: independent objects (shouldn't contend on a global lock) and a single shared object (correctness under contention)
+TEST_CLASS(lv2_sync_test_class)
+{
+	// Priority order (FIFO within the same priority), removal and moving threads between sleep queues
+	TEST_METHOD(sleep_queue_order)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		std::vector<std::shared_ptr<PPUThread>> ppus;
+
+		for (const s32 prio : { 2, 1, 3, 1, 2 })
+		{
+			ppus.emplace_back(idm::make_ptr<PPUThread>("Test PPU"));
+			ppus.back()->prio = prio;
+		}
+
+		sleep_queue_t fifo(false), prio(true);
+
+		for (auto& ppu : ppus)
+		{
+			prio.push(*ppu);
+		}
+
+		const std::vector<u32> expected = { 1, 3, 0, 4, 2 };
+
+		u32 pos = 0;
+
+		for (const auto thread : prio)
+		{
+			Assert::IsTrue(thread == ppus[expected[pos++]].get());
+		}
+
+		Assert::AreEqual<std::size_t>(ppus.size(), prio.size());
+
+		// a thread can't be added twice
+		Assert::ExpectException<std::exception>([&]() { fifo.push(*ppus[0]); });
+
+		Assert::IsTrue(prio.remove(*ppus[0]));
+		Assert::IsFalse(prio.remove(*ppus[0]));
+		Assert::IsFalse(prio.contains(*ppus[0]));
+
+		// the removed thread was the first of its priority, the next one takes its place
+		prio.push(*ppus[0]);
+
+		const std::vector<u32> readded = { 1, 3, 4, 0, 2 };
+
+		pos = 0;
+
+		for (const auto thread : prio)
+		{
+			Assert::IsTrue(thread == ppus[readded[pos++]].get());
+		}
+
+		Assert::IsTrue(prio.remove(*ppus[0]));
+
+		fifo.push(*ppus[0]);
+		Assert::IsTrue(fifo.contains(*ppus[0]));
+
+		while (!prio.empty())
+		{
+			const auto thread = prio.front();
+			prio.pop_front();
+			fifo.push(*thread);
+		}
+
+		const std::vector<u32> moved = { 0, 1, 3, 4, 2 };
+
+		pos = 0;
+
+		for (const auto thread : fifo)
+		{
+			Assert::IsTrue(thread == ppus[moved[pos++]].get());
+		}
+
+		fifo.erase_if([&](sleep_queue_t::value_type& thread) { return thread->get_prio() == 1; });
+
+		Assert::AreEqual<std::size_t>(3, fifo.size());
+
+		fifo.clear();
+
+		for (auto& ppu : ppus)
+		{
+			Assert::IsFalse(fifo.contains(*ppu));
+
+			idm::remove<PPUThread>(ppu->get_id());
+		}
+	}
+
+	TEST_METHOD(mutex_stress)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		const u32 count = get_thread_count();
+
+		std::vector<u32> mutexes;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			mutexes.emplace_back(create_mutex());
+		}
+
+		run_ppu_threads("sys_mutex (private)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_private_iterations; i++)
+			{
+				if (sys_mutex_lock(ppu, mutexes[index], 0) != CELL_OK || sys_mutex_unlock(ppu, mutexes[index]) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		const u32 shared = create_mutex();
+
+		u64 counter = 0; // protected by the shared mutex
+
+		run_ppu_threads("sys_mutex (shared)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_shared_iterations; i++)
+			{
+				if (sys_mutex_lock(ppu, shared, 0) != CELL_OK)
+				{
+					return false;
+				}
+
+				counter++;
+
+				if (sys_mutex_unlock(ppu, shared) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		Assert::AreEqual<u64>(u64{ count } * g_shared_iterations, counter);
+
+		for (const u32 mutex_id : mutexes)
+		{
+			Assert::AreEqual<s32>(CELL_OK, sys_mutex_destroy(mutex_id));
+		}
+
+		Assert::AreEqual<s32>(CELL_OK, sys_mutex_destroy(shared));
+	}
+
+	TEST_METHOD(semaphore_stress)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		const u32 count = get_thread_count();
+
+		std::vector<u32> semaphores;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			semaphores.emplace_back(create_semaphore(0, 1));
+		}
+
+		run_ppu_threads("sys_semaphore (private)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_private_iterations; i++)
+			{
+				if (sys_semaphore_post(semaphores[index], 1) != CELL_OK || sys_semaphore_wait(ppu, semaphores[index], 0) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		// binary semaphore used as a lock
+		const u32 shared = create_semaphore(1, 1);
+
+		u64 counter = 0;
+
+		run_ppu_threads("sys_semaphore (shared)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_shared_iterations; i++)
+			{
+				if (sys_semaphore_wait(ppu, shared, 0) != CELL_OK)
+				{
+					return false;
+				}
+
+				counter++;
+
+				if (sys_semaphore_post(shared, 1) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		Assert::AreEqual<u64>(u64{ count } * g_shared_iterations, counter);
+
+		for (const u32 sem_id : semaphores)
+		{
+			Assert::AreEqual<s32>(CELL_OK, sys_semaphore_destroy(sem_id));
+		}
+
+		Assert::AreEqual<s32>(CELL_OK, sys_semaphore_destroy(shared));
+	}
+
+	TEST_METHOD(lwmutex_stress)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		const u32 count = get_thread_count();
+
+		std::vector<u32> lwmutexes;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			lwmutexes.emplace_back(create_lwmutex());
+		}
+
+		run_ppu_threads("sys_lwmutex (private)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_private_iterations; i++)
+			{
+				if (_sys_lwmutex_unlock(lwmutexes[index]) != CELL_OK || _sys_lwmutex_lock(ppu, lwmutexes[index], 0) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		// the lv2 part of lwmutex is a sleep queue: it's initially unsignaled, unlock() signals it once
+		const u32 shared = create_lwmutex();
+
+		Assert::AreEqual<s32>(CELL_OK, _sys_lwmutex_unlock(shared));
+
+		u64 counter = 0;
+
+		run_ppu_threads("sys_lwmutex (shared)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_shared_iterations; i++)
+			{
+				if (_sys_lwmutex_lock(ppu, shared, 0) != CELL_OK)
+				{
+					return false;
+				}
+
+				counter++;
+
+				if (_sys_lwmutex_unlock(shared) != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		Assert::AreEqual<u64>(u64{ count } * g_shared_iterations, counter);
+
+		for (const u32 lwmutex_id : lwmutexes)
+		{
+			Assert::AreEqual<s32>(CELL_OK, _sys_lwmutex_destroy(lwmutex_id));
+		}
+
+		Assert::AreEqual<s32>(CELL_OK, _sys_lwmutex_destroy(shared));
+	}
+
+	TEST_METHOD(event_queue_stress)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		const u32 count = get_thread_count();
+
+		std::vector<std::pair<u32, u32>> queues;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			queues.emplace_back(create_event_queue(1));
+		}
+
+		run_ppu_threads("sys_event_queue (private)", count, [&](u32 index, PPUThread& ppu)
+		{
+			for (u32 i = 0; i < g_private_iterations; i++)
+			{
+				if (sys_event_port_send(queues[index].second, index, i, 0) != CELL_OK || sys_event_queue_receive(ppu, queues[index].first, vm::null, 0) != CELL_OK)
+				{
+					return false;
+				}
+
+				if (ppu.GPR[5] != index || ppu.GPR[6] != i)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		// thread 0 receives the events sent by all other threads
+		const auto shared = create_event_queue(127);
+
+		std::vector<u32> received(count);
+
+		run_ppu_threads("sys_event_queue (shared)", count, [&](u32 index, PPUThread& ppu)
+		{
+			if (index == 0)
+			{
+				for (u32 i = 0; i < (count - 1) * g_shared_iterations; i++)
+				{
+					if (sys_event_queue_receive(ppu, shared.first, vm::null, 0) != CELL_OK || ppu.GPR[5] >= count || ppu.GPR[6] != received[ppu.GPR[5]]++)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			for (u32 i = 0; i < g_shared_iterations; i++)
+			{
+				s32 res;
+
+				while ((res = sys_event_port_send(shared.second, index, i, 0)) == CELL_EBUSY)
+				{
+					std::this_thread::yield();
+				}
+
+				if (res != CELL_OK)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		});
+
+		for (u32 i = 1; i < count; i++)
+		{
+			Assert::AreEqual<u32>(g_shared_iterations, received[i]);
+		}
+
+		queues.emplace_back(shared);
+
+		for (const auto& queue : queues)
+		{
+			Assert::AreEqual<s32>(CELL_OK, sys_event_port_disconnect(queue.second));
+			Assert::AreEqual<s32>(CELL_OK, sys_event_port_destroy(queue.second));
+			Assert::AreEqual<s32>(CELL_OK, sys_event_queue_destroy(queue.first, 0));
+		}
+	}
+};
@@ -0,0 +1,92 @@
+#include "stdafx.h"
+
+#include "Emu/Cell/SPUAnalyser.h"
+
+#include <chrono>
+
+TEST_CLASS(ps3_spu_database)
+{
+	// Write SPU job at LS address (ILA $3,0 followed by `count` distinct ILA instructions and STOP 0), returns function size
+	static u32 write_job(std::vector<be_t<u32>>& ls, u32 addr, u32 count, u32 seed)
+	{
+		ls[addr / 4] = 0x21u << 25 | 3;
+
+		for (u32 i = 1; i <= count; i++)
+		{
+			ls[addr / 4 + i] = 0x21u << 25 | ((seed * i) & 0x3ffff) << 7 | 3;
+		}
+
+		ls[addr / 4 + count + 1] = 0;
+
+		return (count + 2) * 4;
+	}
+
+	// Many distinct jobs sharing entry point and first instruction (long candidate chains before size/hash indexing)
+	TEST_METHOD(same_entry_jobs)
+	{
+		const u32 entry = 0x1000;
+		const u32 job_count = 4096;
+
+		SPUDatabase db;
+
+		std::vector<be_t<u32>> ls(0x40000 / 4);
+		std::vector<std::shared_ptr<spu_function_t>> funcs(job_count);
+
+		for (u32 i = 0; i < job_count; i++)
+		{
+			const u32 size = write_job(ls, entry, 1 + i % 64, i + 1);
+
+			funcs[i] = db.analyse(ls.data(), entry);
+
+			if (!funcs[i] || funcs[i]->size != size)
+			{
+				TEST_FAILURE("Job %u not analysed (size=0x%x)", i, size);
+			}
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 pass = 0; pass < 4; pass++)
+		{
+			for (u32 i = 0; i < job_count; i++)
+			{
+				write_job(ls, entry, 1 + i % 64, i + 1);
+
+				if (db.analyse(ls.data(), entry) != funcs[i])
+				{
+					TEST_FAILURE("Job %u: lookup returned another function", i);
+				}
+			}
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		TEST_LOG("%u lookups: %lld us\n", job_count * 4, static_cast<long long>(elapsed));
+	}
+
+	// Functions differing only after the shortest registered size must not be confused
+	TEST_METHOD(prefix_collision)
+	{
+		const u32 entry = 0x2000;
+
+		SPUDatabase db;
+
+		std::vector<be_t<u32>> ls(0x40000 / 4);
+
+		write_job(ls, entry, 4, 7);
+		const auto short_func = db.analyse(ls.data(), entry);
+
+		write_job(ls, entry, 8, 7);
+		const auto long_func = db.analyse(ls.data(), entry);
+
+		Assert::IsTrue(short_func && long_func && short_func != long_func);
+		Assert::AreEqual(24u, short_func->size);
+		Assert::AreEqual(40u, long_func->size);
+
+		write_job(ls, entry, 4, 7);
+		Assert::IsTrue(db.analyse(ls.data(), entry) == short_func);
+
+		write_job(ls, entry, 8, 7);
+		Assert::IsTrue(db.analyse(ls.data(), entry) == long_func);
+	}
+};
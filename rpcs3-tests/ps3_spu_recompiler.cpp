@@ -0,0 +1,143 @@
+#include "stdafx.h"
+
+#include "Emu/IdManager.h"
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/SPUInterpreter.h"
+#include "Emu/Cell/SPUAnalyser.h"
+#include "Emu/Cell/SPUASMJITRecompiler.h"
+
+#include <random>
+
+namespace
+{
+	using spu_interp_fn = void(*)(SPUThread&, spu_opcode_t);
+
+	// RR form (11-bit opcode)
+	u32 spu_rr(u32 opcode, u32 rt, u32 ra, u32 rb)
+	{
+		return opcode << 21 | rb << 14 | ra << 7 | rt;
+	}
+
+	// RI7 form (11-bit opcode)
+	u32 spu_ri7(u32 opcode, u32 rt, u32 ra, u32 i7)
+	{
+		return opcode << 21 | (i7 & 0x7f) << 14 | ra << 7 | rt;
+	}
+
+	// RI16 form (9-bit opcode)
+	u32 spu_ri16(u32 opcode, u32 rt, u32 i16)
+	{
+		return opcode << 23 | (i16 & 0xffff) << 7 | rt;
+	}
+
+	// RRR form (4-bit opcode)
+	u32 spu_rrr(u32 opcode, u32 rt, u32 ra, u32 rb, u32 rc)
+	{
+		return opcode << 28 | rt << 21 | rb << 14 | ra << 7 | rc;
+	}
+
+	// Compile single instruction with the ASMJIT recompiler and compare all registers with the interpreter
+	void verify_spu_instruction_against_interpreter(u32 opcode, spu_interp_fn interp_fn, u32 count = 200)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		static spu_recompiler recompiler;
+
+		spu_function_t func(0, 4);
+		func.data.resize(1);
+		func.data[0] = opcode;
+		func.blocks.emplace(0);
+
+		recompiler.compile(func);
+
+		const auto compiled = func.compiled.load();
+
+		if (!compiled)
+		{
+			TEST_FAILURE("Compilation failed (opcode 0x%08x)", opcode);
+		}
+
+		const auto spu = idm::make_ptr<SPUThread>("Test SPU", 0);
+		const auto _ls = vm::ps3::_ptr<u32>(spu->offset);
+
+		std::mt19937_64 rng(opcode);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			std::array<v128, 128> input;
+
+			for (auto& reg : input)
+			{
+				reg._u64[0] = rng();
+				reg._u64[1] = rng();
+			}
+
+			spu->gpr = input;
+			spu->pc = 0;
+
+			const u32 next = compiled(spu.get(), _ls);
+
+			const std::array<v128, 128> recomp = spu->gpr;
+
+			spu->gpr = input;
+			interp_fn(*spu, { opcode });
+
+			if (next != 4)
+			{
+				TEST_FAILURE("Opcode 0x%08x: unexpected next address 0x%x", opcode, next);
+			}
+
+			for (u32 r = 0; r < 128; r++)
+			{
+				if (recomp[r] != spu->gpr[r])
+				{
+					TEST_FAILURE("Opcode 0x%08x, GPR[%u]: recomp 0x%s, interp 0x%s", opcode, r, recomp[r].to_hex(), spu->gpr[r].to_hex());
+				}
+			}
+		}
+
+		idm::remove<SPUThread>(spu->get_id());
+	}
+}
+
+#define TEST_SPU_INSTRUCTION(name, opcode) \
+	TEST_METHOD(name) \
+	{ \
+		verify_spu_instruction_against_interpreter(opcode, &spu_interpreter::name); \
+	}
+
+#define TEST_SPU_INSTRUCTION_EX(test, name, opcode) \
+	TEST_METHOD(test) \
+	{ \
+		verify_spu_instruction_against_interpreter(opcode, &spu_interpreter::name); \
+	}
+
+TEST_CLASS(spu_recompiler_test_class)
+{
+	// shuffle and select
+	TEST_SPU_INSTRUCTION(SHUFB, spu_rrr(0xb, 3, 4, 5, 6));
+	TEST_SPU_INSTRUCTION_EX(SHUFB_same_regs, SHUFB, spu_rrr(0xb, 4, 4, 4, 5));
+	TEST_SPU_INSTRUCTION_EX(SHUFB_mask_is_source, SHUFB, spu_rrr(0xb, 6, 4, 5, 4));
+	TEST_SPU_INSTRUCTION(SELB, spu_rrr(0x8, 3, 4, 5, 6));
+	TEST_SPU_INSTRUCTION_EX(SELB_same_regs, SELB, spu_rrr(0x8, 5, 5, 6, 5));
+
+	// gather
+	TEST_SPU_INSTRUCTION(GB, spu_rr(0x1b0, 3, 4, 0));
+	TEST_SPU_INSTRUCTION(GBH, spu_rr(0x1b1, 3, 4, 0));
+	TEST_SPU_INSTRUCTION(GBB, spu_rr(0x1b2, 3, 4, 0));
+
+	// form select mask
+	TEST_SPU_INSTRUCTION(FSM, spu_rr(0x1b4, 3, 4, 0));
+	TEST_SPU_INSTRUCTION(FSMH, spu_rr(0x1b5, 3, 4, 0));
+	TEST_SPU_INSTRUCTION(FSMB, spu_rr(0x1b6, 3, 4, 0));
+	TEST_SPU_INSTRUCTION(FSMBI, spu_ri16(0x65, 3, 0xa55a));
+
+	// quadword rotates and shifts by bytes
+	TEST_SPU_INSTRUCTION(ROTQBY, spu_rr(0x1dc, 3, 4, 5));
+	TEST_SPU_INSTRUCTION_EX(ROTQBY_same_regs, ROTQBY, spu_rr(0x1dc, 4, 4, 4));
+	TEST_SPU_INSTRUCTION(ROTQBYBI, spu_rr(0x1cc, 3, 4, 5));
+	TEST_SPU_INSTRUCTION(ROTQMBY, spu_rr(0x1dd, 3, 4, 5));
+	TEST_SPU_INSTRUCTION(SHLQBY, spu_rr(0x1df, 3, 4, 5));
+	TEST_SPU_INSTRUCTION(ROTQBYI, spu_ri7(0x1fc, 3, 4, 5));
+};
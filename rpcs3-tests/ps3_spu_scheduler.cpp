@@ -0,0 +1,133 @@
+#include "stdafx.h"
+
+#include "Emu/state.h"
+#include "Emu/Cell/SPUThread.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	const u32 g_contexts = 36; // 6 groups of 6 SPU threads
+	const u32 g_slices = 64; // time slices per context
+	const u32 g_slice_work = 200000; // arithmetic iterations per time slice
+
+	volatile u64 g_sink;
+
+	// SPU thread context which is never started (only used as a scheduler client)
+	class bench_spu_thread final : public SPUThread
+	{
+	public:
+		bench_spu_thread(const std::string& name, u32 index)
+			: SPUThread(name, index)
+		{
+			// the scheduler gives up waiting for stopped threads
+			m_state &= ~CPU_STATE_STOPPED;
+		}
+	};
+
+	// Emulated SPU time slice
+	void spu_compute(u64 seed)
+	{
+		u64 x = seed;
+
+		for (u32 i = 0; i < g_slice_work; i++)
+		{
+			x = x * 6364136223846793005ull + 1442695040888963407ull;
+		}
+
+		g_sink = x;
+	}
+
+	// Run all contexts with the specified number of scheduler slots (0 = one host thread per context without the scheduler), returns elapsed microseconds
+	u64 run_spu_workload(u32 workers)
+	{
+		rpcs3::state.config.core.spu_workers = workers;
+
+		const auto sched = workers ? std::make_shared<spu_scheduler_t>() : nullptr;
+
+		std::vector<std::unique_ptr<bench_spu_thread>> spus;
+
+		for (u32 i = 0; i < g_contexts; i++)
+		{
+			spus.emplace_back(std::make_unique<bench_spu_thread>(fmt::format("Bench SPU %u", i), i % 6));
+		}
+
+		std::vector<std::thread> threads;
+
+		atomic_t<u32> failed{ 0 };
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 i = 0; i < g_contexts; i++)
+		{
+			threads.emplace_back([&, i]()
+			{
+				const s32 prio = 100 + i / 6; // group priority
+
+				for (u32 s = 0; s < g_slices; s++)
+				{
+					if (sched && !sched->acquire(*spus[i], prio))
+					{
+						failed++;
+						return;
+					}
+
+					spu_compute(i * g_slices + s);
+
+					if (sched)
+					{
+						sched->release();
+					}
+
+					// blocking channel read (the slot is released while waiting)
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		if (failed.load())
+		{
+			TEST_FAILURE("%u contexts failed to acquire a slot (%u workers)", failed.load(), workers);
+		}
+
+		const u64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		if (sched)
+		{
+			TEST_LOG("%u workers: %llu us, %llu slices/s, %llu context switches\n", workers, elapsed, u64{ g_contexts } * g_slices * 1000000 / elapsed, sched->switches.load());
+		}
+		else
+		{
+			TEST_LOG("unlimited: %llu us, %llu slices/s\n", elapsed, u64{ g_contexts } * g_slices * 1000000 / elapsed);
+		}
+
+		return elapsed;
+	}
+}
+
+TEST_CLASS(spu_scheduler_test_class)
+{
+	// Throughput of the scheduler with 4, 8 and 16 slots compared to one host thread per SPU context
+	TEST_METHOD(throughput)
+	{
+		Emu.SetTestMode();
+		vm::ps3::init();
+
+		TEST_LOG("host threads: %u, SPU contexts: %u\n", std::thread::hardware_concurrency(), g_contexts);
+
+		run_spu_workload(0);
+
+		for (const u32 workers : { 4u, 8u, 16u })
+		{
+			run_spu_workload(workers);
+		}
+
+		rpcs3::state.config.core.spu_workers = 0;
+	}
+};
@@ -10,6 +10,7 @@
 #include "sceLibKernel.h"
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 s32 sceKernelAllocMemBlock(vm::cptr<char> name, s32 type, u32 vsize, vm::ptr<SceKernelAllocMemBlockOpt> pOpt)
 {
@@ -493,7 +494,7 @@ s32 sceKernelWaitEventFlag(ARMv7Thread& context, s32 evfId, u32 bitPattern, u32
 				break;
 			}
 
-			context.cv.wait_for(lock, std::chrono::microseconds(timeout - passed));
+			context.cv.wait_for(lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -579,7 +580,7 @@ s32 sceKernelSetEventFlag(s32 evfId, u32 bitPattern)
 	};
 
 	// check all waiters; protocol is ignored in current implementation
-	evf->sq.erase(std::remove_if(evf->sq.begin(), evf->sq.end(), pred), evf->sq.end());
+	evf->sq.erase_if(pred);
 
 	return SCE_OK;
 }
@@ -0,0 +1,247 @@
+#include "stdafx.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Emu/SysCalls/SysCalls.h"
+
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/SPUAnalyser.h"
+#include "CPUThreadManager.h"
+#include "CPUProfiler.h"
+
+// Max number of return addresses collected per sample
+const u32 g_profiler_max_depth = 32;
+
+// Max distance from the nearest preceding PPU symbol (symbol sizes are unknown)
+const u32 g_profiler_max_symbol_distance = 0x1000;
+
+cpu_profiler_t::cpu_profiler_t(const std::string& path, u32 interval)
+	: m_path(path)
+	, m_interval(interval)
+{
+}
+
+void cpu_profiler_t::on_task()
+{
+	LOG_SUCCESS(GENERAL, "Profiler started (interval: %u us, output: %s)", m_interval, m_path);
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!m_stop && !Emu.IsStopped())
+	{
+		if (!Emu.IsPaused())
+		{
+			for (auto& t : CPUThreadManager::GetAllThreads())
+			{
+				sample(*t);
+			}
+		}
+
+		cv.wait_for(lock, std::chrono::microseconds(m_interval));
+	}
+
+	save();
+}
+
+void cpu_profiler_t::on_id_aux_finalize()
+{
+	m_stop = true;
+	cv.notify_one();
+	join();
+}
+
+void cpu_profiler_t::sample(CPUThread& cpu)
+{
+	if (!cpu.is_alive() || cpu.is_stopped() || cpu.is_paused())
+	{
+		return;
+	}
+
+	// Registers are read without synchronization, so the call chain is validated on every step
+	std::vector<u32> stack;
+	u64 hle_code = 0;
+
+	switch (cpu.get_type())
+	{
+	case CPU_THREAD_PPU:
+	{
+		auto& ppu = static_cast<PPUThread&>(cpu);
+
+		const u32 lr = static_cast<u32>(ppu.LR);
+
+		hle_code = ppu.hle_code;
+		stack.emplace_back(ppu.PC);
+		stack.emplace_back(lr);
+
+		// Walk the back chain: the return address is saved at offset 16 of the caller's frame
+		for (u32 sp = static_cast<u32>(ppu.GPR[1]), i = 0; i < g_profiler_max_depth && vm::check_addr(sp, 8); i++)
+		{
+			const u32 next = static_cast<u32>(vm::ps3::read64(sp));
+
+			if (next <= sp || !vm::check_addr(next, 24))
+			{
+				break;
+			}
+
+			const u32 addr = static_cast<u32>(vm::ps3::read64(next + 16));
+
+			if (!addr)
+			{
+				break;
+			}
+
+			// LR may have already been saved by the current function
+			if (i || addr != lr)
+			{
+				stack.emplace_back(addr);
+			}
+
+			sp = next;
+		}
+
+		break;
+	}
+
+	case CPU_THREAD_SPU:
+	case CPU_THREAD_RAW_SPU:
+	{
+		auto& spu = static_cast<SPUThread&>(cpu);
+
+		const u32 lr = spu.gpr[0]._u32[3] & 0x3fffc;
+
+		stack.emplace_back(spu.pc);
+		stack.emplace_back(lr);
+
+		// Walk the back chain: the return address is saved at offset 16 of the caller's frame
+		for (u32 sp = spu.gpr[1]._u32[3] & 0x3fff0, i = 0; i < g_profiler_max_depth; i++)
+		{
+			const u32 next = spu._ref<u32>(sp) & 0x3fff0;
+
+			if (next <= sp || next + 16 >= 0x40000)
+			{
+				break;
+			}
+
+			const u32 addr = spu._ref<u32>(next + 16) & 0x3fffc;
+
+			if (!addr)
+			{
+				break;
+			}
+
+			if (i || addr != lr)
+			{
+				stack.emplace_back(addr);
+			}
+
+			sp = next;
+		}
+
+		break;
+	}
+
+	default:
+	{
+		stack.emplace_back(cpu.get_pc());
+	}
+	}
+
+	m_samples[std::make_tuple(cpu.get_type(), cpu.GetFName(), hle_code, std::move(stack))]++;
+	m_sample_count++;
+}
+
+void cpu_profiler_t::save() const
+{
+	const auto symbols = fxm::get_always<cpu_symbol_map_t>();
+	const auto spu_db = fxm::get<SPUDatabase>();
+
+	// Symbolization cache ((is_spu << 32 | address) -> name)
+	std::unordered_map<u64, std::string> names;
+
+	const auto get_ppu_name = [&](u32 addr) -> std::string
+	{
+		std::lock_guard<std::mutex> lock(symbols->mutex);
+
+		auto found = symbols->ppu.upper_bound(addr);
+
+		if (found != symbols->ppu.begin() && addr - (--found)->first < g_profiler_max_symbol_distance)
+		{
+			return found->second;
+		}
+
+		return fmt::format("0x%08x", addr);
+	};
+
+	const auto get_spu_name = [&](u32 addr) -> std::string
+	{
+		if (const auto func = spu_db ? spu_db->find_function(addr) : nullptr)
+		{
+			return fmt::format("spu_0x%05x", func->addr);
+		}
+
+		return fmt::format("spu+0x%05x", addr);
+	};
+
+	std::string result;
+
+	for (auto& sample : m_samples)
+	{
+		const CPUThreadType type = std::get<0>(sample.first);
+		const u64 hle_code = std::get<2>(sample.first);
+		const auto& stack = std::get<3>(sample.first);
+		const bool is_spu = type == CPU_THREAD_SPU || type == CPU_THREAD_RAW_SPU;
+
+		// Frames are written from the outermost one
+		result += std::get<1>(sample.first);
+
+		for (auto it = stack.rbegin(); it != stack.rend(); it++)
+		{
+			auto& name = names[u64{ is_spu } << 32 | *it];
+
+			if (name.empty())
+			{
+				name = is_spu ? get_spu_name(*it) : get_ppu_name(*it);
+			}
+
+			result += ';';
+			result += name;
+		}
+
+		if (hle_code)
+		{
+			result += ";HLE:";
+			result += get_ps3_function_name(hle_code);
+		}
+
+		result += fmt::format(" %llu\n", sample.second);
+	}
+
+	fs::file(m_path, fom::rewrite).write(result);
+
+	LOG_SUCCESS(GENERAL, "Profiler: %llu samples written to %s", m_sample_count, m_path);
+}
+
+void cpu_profiler_add_symbol(u32 addr, const std::string& name)
+{
+	const auto symbols = fxm::get_always<cpu_symbol_map_t>();
+
+	std::lock_guard<std::mutex> lock(symbols->mutex);
+
+	symbols->ppu[addr] = name;
+}
+
+bool cpu_profiler_start(const std::string& path, u32 interval)
+{
+	return fxm::make<cpu_profiler_t>(path, interval) != nullptr;
+}
+
+bool cpu_profiler_stop()
+{
+	return fxm::remove<cpu_profiler_t>();
+}
+
+bool cpu_profiler_is_running()
+{
+	return fxm::check<cpu_profiler_t>();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CPUThread.h"
+
+// Names of guest PPU functions (filled by the loader, used for symbolization)
+struct cpu_symbol_map_t
+{
+	std::mutex mutex;
+
+	// function address -> name
+	std::map<u32, std::string> ppu;
+};
+
+// Sampling guest PC profiler (output is written in "folded stacks" format for flame graph tools)
+class cpu_profiler_t final : public named_thread_t
+{
+	using sample_key_t = std::tuple<CPUThreadType, std::string, u64, std::vector<u32>>;
+
+	const std::string m_path;
+
+	// Sampling interval (in microseconds)
+	const u32 m_interval;
+
+	atomic_t<bool> m_stop{ false };
+
+	// (thread type, thread name, HLE function or syscall code, call chain from the innermost frame) -> sample count
+	std::map<sample_key_t, u64> m_samples;
+
+	u64 m_sample_count = 0;
+
+	void on_task() override;
+	void on_id_aux_finalize() override;
+
+	// Capture PC and return chain of the thread
+	void sample(CPUThread& cpu);
+
+	// Write folded stacks
+	void save() const;
+
+public:
+	cpu_profiler_t(const std::string& path, u32 interval);
+
+	std::string get_name() const override { return "CPU Profiler"; }
+};
+
+// Register a name for the guest PPU function
+void cpu_profiler_add_symbol(u32 addr, const std::string& name);
+
+// Start sampling all CPU threads (returns false if already started)
+bool cpu_profiler_start(const std::string& path, u32 interval = 1000);
+
+// Stop sampling and write results (returns false if not started)
+bool cpu_profiler_stop();
+
+bool cpu_profiler_is_running();
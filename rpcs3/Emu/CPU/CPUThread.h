@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/Thread.h"
+#include "Utilities/SleepQueue.h"
 
 enum CPUThreadType
 {
@@ -50,17 +51,21 @@ protected:
 public:
 	virtual ~CPUThread() override;
 
+	sleep_queue_node_t sleep_node{ this }; // link used by sleep_queue_t (protected by the lock of the sleep queue owner)
+
 	virtual std::string get_name() const override;
 	u32 get_id() const { return m_id; }
 	CPUThreadType get_type() const { return m_type; }
 
 	bool is_alive() const { return (m_state & CPU_STATE_DEAD) == 0; }
 	bool is_stopped() const { return (m_state & CPU_STATE_STOPPED) != 0; }
+	bool is_sleeping() const { return (m_state & CPU_STATE_SLEEP) != 0; }
 	virtual bool is_paused() const;
 
 	virtual void dump_info() const;
 	virtual u32 get_pc() const = 0;
 	virtual u32 get_offset() const = 0;
+	virtual s32 get_prio() const { return 0; } // scheduling priority (lower value is higher priority)
 	virtual void do_run() = 0;
 	virtual void cpu_task() = 0;
 
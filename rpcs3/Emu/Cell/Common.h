@@ -15,9 +15,18 @@ struct ppu_decoder_cache_t
 {
 	ppu_inter_func_t* const pointer;
 
+	// Decoded pages (one byte per 4 KiB page)
+	std::unique_ptr<atomic_t<u8>[]> const pages;
+
+	// Invalidation counters (pages modified too often are executed without caching and aren't watched)
+	std::unique_ptr<atomic_t<u8>[]> const writes;
+
 	ppu_decoder_cache_t();
 
 	~ppu_decoder_cache_t();
 
 	void initialize(u32 addr, u32 size);
+
+	// Reset decoded functions in the modified area, they will be decoded again on execution
+	void invalidate(u32 addr, u32 size);
 };
@@ -100,10 +100,12 @@ Compiler::Compiler(LLVMContext *context, llvm::IRBuilder<> *builder, std::unorde
 	arg_types.push_back(m_ir_builder->getInt64Ty());
 	m_compiled_function_type = FunctionType::get(m_ir_builder->getInt32Ty(), arg_types, false);
 
-	if (!s_rotate_mask_inited) {
+	// Compilers may be created concurrently by ahead-of-time compilation workers
+	static std::once_flag rotate_mask_once;
+	std::call_once(rotate_mask_once, [] {
 		InitRotateMask();
 		s_rotate_mask_inited = true;
-	}
+	});
 }
 
 Compiler::~Compiler() {
@@ -216,9 +218,14 @@ RecompilationEngine::RecompilationEngine()
 	// Each char can store 8 page status
 	FunctionCachePagesCommited = (char *)malloc(VIRTUAL_INSTRUCTION_COUNT / (8 * PAGE_SIZE));
 	memset(FunctionCachePagesCommited, 0, VIRTUAL_INSTRUCTION_COUNT / (8 * PAGE_SIZE));
+
+	vm::add_code_watcher(this, [this](u32 addr, u32 size) {
+		InvalidateRange(addr, size);
+	});
 }
 
 RecompilationEngine::~RecompilationEngine() {
+	vm::remove_code_watcher(this);
 	m_executable_storage.clear();
 	memory_helper::free_reserved_memory(FunctionCache, VIRTUAL_INSTRUCTION_COUNT * sizeof(ExecutableStorageType));
 	free(FunctionCachePagesCommited);
@@ -270,6 +277,19 @@ void RecompilationEngine::NotifyBlockStart(u32 address) {
 	// TODO: Increase the priority of the recompilation engine thread
 }
 
+void RecompilationEngine::QueuePrecompileRange(u32 address, u32 size) {
+	{
+		std::lock_guard<std::mutex> lock(m_pending_address_start_lock);
+		m_pending_precompile.emplace_back(address, size);
+	}
+
+	if (!is_started()) {
+		start();
+	}
+
+	cv.notify_one();
+}
+
 raw_fd_ostream & RecompilationEngine::Log() {
 	if (!m_log) {
 		std::error_code error;
@@ -288,13 +308,23 @@ void RecompilationEngine::on_task() {
 	while (!Emu.IsStopped()) {
 		bool             work_done_this_iteration = false;
 		std::list <u32> m_current_execution_traces;
+		std::vector<std::pair<u32, u32> > precompile_ranges;
 
 		{
 			std::lock_guard<std::mutex> lock(m_pending_address_start_lock);
 			m_current_execution_traces.swap(m_pending_address_start);
+			precompile_ranges.swap(m_pending_precompile);
 		}
 
-		if (!m_current_execution_traces.empty()) {
+		// PrecompileRange takes m_compile_lock itself
+		for (auto & range : precompile_ranges) {
+			PrecompileRange(range.first, range.second);
+			work_done_this_iteration = true;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_compile_lock);
+			ProcessInvalidations();
 			for (u32 address : m_current_execution_traces)
 				work_done_this_iteration |= IncreaseHitCounterAndBuild(address);
 		}
@@ -373,10 +403,7 @@ static void wrapped_trap(PPUThread &CPU, u32) noexcept {
 	}
 }
 
-std::pair<Executable, llvm::ExecutionEngine *> RecompilationEngine::compile(const std::string & name, u32 start_address, u32 instruction_count) {
-	std::unique_ptr<llvm::Module> module = Compiler::create_module(m_llvm_context);
-
-	std::unordered_map<std::string, void*> function_ptrs;
+void RecompilationEngine::InitFunctionPtrs(std::unordered_map<std::string, void*> & function_ptrs) {
 	function_ptrs["execute_unknown_function"] = reinterpret_cast<void*>(CPUHybridDecoderRecompiler::ExecuteFunction);
 	function_ptrs["execute_unknown_block"] = reinterpret_cast<void*>(CPUHybridDecoderRecompiler::ExecuteTillReturn);
 	function_ptrs["PollStatus"] = reinterpret_cast<void*>(CPUHybridDecoderRecompiler::PollStatus);
@@ -398,14 +425,12 @@ std::pair<Executable, llvm::ExecutionEngine *> RecompilationEngine::compile(cons
 	MACRO_PPU_INST_G_3A_EXPANDERS(REGISTER_FUNCTION_PTR)
 	MACRO_PPU_INST_G_3E_EXPANDERS(REGISTER_FUNCTION_PTR)
 
-	Compiler(&m_llvm_context, &m_ir_builder, function_ptrs)
-		.translate_to_llvm_ir(module.get(), name, start_address, instruction_count);
+#undef REGISTER_FUNCTION_PTR
+}
 
+llvm::ExecutionEngine * RecompilationEngine::CreateExecutionEngine(std::unique_ptr<llvm::Module> module, std::unordered_map<std::string, void*> & function_ptrs) {
 	llvm::Module *module_ptr = module.get();
 
-	Log() << *module_ptr;
-	Compiler::optimise_module(module_ptr);
-
 	llvm::ExecutionEngine *execution_engine =
 		EngineBuilder(std::move(module))
 		.setEngineKind(EngineKind::JIT)
@@ -418,6 +443,25 @@ std::pair<Executable, llvm::ExecutionEngine *> RecompilationEngine::compile(cons
 	// Translate to machine code
 	execution_engine->finalizeObject();
 
+	return execution_engine;
+}
+
+std::pair<Executable, llvm::ExecutionEngine *> RecompilationEngine::compile(const std::string & name, u32 start_address, u32 instruction_count) {
+	std::unique_ptr<llvm::Module> module = Compiler::create_module(m_llvm_context);
+
+	std::unordered_map<std::string, void*> function_ptrs;
+	InitFunctionPtrs(function_ptrs);
+
+	Compiler(&m_llvm_context, &m_ir_builder, function_ptrs)
+		.translate_to_llvm_ir(module.get(), name, start_address, instruction_count);
+
+	llvm::Module *module_ptr = module.get();
+
+	Log() << *module_ptr;
+	Compiler::optimise_module(module_ptr);
+
+	llvm::ExecutionEngine *execution_engine = CreateExecutionEngine(std::move(module), function_ptrs);
+
 	Function *llvm_function = module_ptr->getFunction(name);
 	void *function = execution_engine->getPointerToFunction(llvm_function);
 
@@ -437,6 +481,36 @@ std::pair<Executable, llvm::ExecutionEngine *> RecompilationEngine::compile(cons
 	return std::make_pair((Executable)function, execution_engine);
 }
 
+std::pair<std::vector<Executable>, llvm::ExecutionEngine *> RecompilationEngine::compile_batch(llvm::LLVMContext & context, const std::vector<BlockEntry> & blocks) {
+	std::unique_ptr<llvm::Module> module = Compiler::create_module(context);
+	llvm::IRBuilder<> ir_builder(context);
+
+	std::unordered_map<std::string, void*> function_ptrs;
+	InitFunctionPtrs(function_ptrs);
+
+	for (const BlockEntry & block : blocks) {
+		Compiler(&context, &ir_builder, function_ptrs)
+			.translate_to_llvm_ir(module.get(), fmt::format("fn_0x%08X", block.address), block.address, block.instructionCount);
+	}
+
+	llvm::Module *module_ptr = module.get();
+
+	Compiler::optimise_module(module_ptr);
+
+	llvm::ExecutionEngine *execution_engine = CreateExecutionEngine(std::move(module), function_ptrs);
+
+	std::vector<Executable> executables;
+	executables.reserve(blocks.size());
+
+	for (const BlockEntry & block : blocks) {
+		Function *llvm_function = module_ptr->getFunction(fmt::format("fn_0x%08X", block.address));
+		executables.push_back((Executable)execution_engine->getPointerToFunction(llvm_function));
+		assert(executables.back() != nullptr);
+	}
+
+	return std::make_pair(std::move(executables), execution_engine);
+}
+
 /**
 * This code is inspired from Dolphin PPC Analyst
 */
@@ -528,17 +602,200 @@ void RecompilationEngine::CompileBlock(BlockEntry & block_entry) {
 		const std::pair<Executable, llvm::ExecutionEngine *> &compileResult =
 			compile(fmt::format("fn_0x%08X", block_entry.address), block_entry.address, block_entry.instructionCount);
 
-		if (!isAddressCommited(block_entry.address / 4))
-			commitAddress(block_entry.address / 4);
-
 		m_executable_storage.push_back(std::unique_ptr<llvm::ExecutionEngine>(compileResult.second));
-		Log() << "Associating " << (void*)(uint64_t)block_entry.address << " with ID " << m_currentId << "\n";
-		FunctionCache[block_entry.address / 4] = std::make_pair(compileResult.first, m_currentId);
-		m_currentId++;
+		PublishExecutable(block_entry.address, block_entry.instructionCount * 4, compileResult.first);
 		block_entry.is_compiled = true;
 	}
 }
 
+void RecompilationEngine::PublishExecutable(u32 address, u32 size, Executable executable) {
+	if (!isAddressCommited(address / 4))
+		commitAddress(address / 4);
+
+	// Modification of the code will invalidate the executable
+	const u32 page = address & ~0xfff;
+	vm::watch_code(page, align(address + std::max<u32>(size, 4), 4096) - page);
+
+	Log() << "Associating " << (void*)(uint64_t)address << " with ID " << m_currentId << "\n";
+	FunctionCache[address / 4] = std::make_pair(executable, m_currentId);
+	m_currentId++;
+}
+
+void RecompilationEngine::InvalidateRange(u32 address, u32 size) {
+	// Called from the access violation handler or with vm locks held: m_compile_lock can't be taken here
+	const u32 instr_per_page = 4096 / sizeof(ExecutableStorageType);
+
+	for (u32 i = address / 4; i < (address + (size - 1)) / 4 + 1;) {
+		if (!isAddressCommited(i)) {
+			i = (i / instr_per_page + 1) * instr_per_page;
+			continue;
+		}
+
+		FunctionCache[i++].first = nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_pending_invalidations_lock);
+	m_pending_invalidations.emplace_back(address, size);
+}
+
+void RecompilationEngine::ProcessInvalidations() {
+	std::vector<std::pair<u32, u32>> ranges;
+
+	{
+		std::lock_guard<std::mutex> lock(m_pending_invalidations_lock);
+		ranges.swap(m_pending_invalidations);
+	}
+
+	if (ranges.empty())
+		return;
+
+	for (auto It = m_block_table.begin(); It != m_block_table.end();) {
+		const u32 start = It->second.address;
+		const u32 end = start + std::max<u32>(It->second.instructionCount * 4, 4);
+
+		bool modified = false;
+		for (const auto & range : ranges)
+			modified |= start < range.first + range.second && range.first < end;
+
+		if (!modified) {
+			++It;
+			continue;
+		}
+
+		// The machine code itself is kept in m_executable_storage as it may still be running
+		if (isAddressCommited(start / 4))
+			FunctionCache[start / 4].first = nullptr;
+
+		Log() << "Invalidated " << It->second.ToString() << "\n";
+		It = m_block_table.erase(It);
+	}
+}
+
+std::vector<u32> RecompilationEngine::DiscoverFunctions(u32 address, u32 size) const {
+	std::set<u32> entries;
+
+	// The first instruction following a return (or the start of the area) begins a new function
+	bool after_return = true;
+
+	for (u32 instructionAddress = address; instructionAddress < address + size; instructionAddress += 4) {
+		const u32 instr = vm::ps3::read32(instructionAddress);
+
+		// Skip alignment padding
+		if (instr == 0 || instr == PPU_instr::implicts::NOP())
+			continue;
+
+		if (after_return) {
+			entries.insert(instructionAddress);
+			after_return = false;
+		}
+
+		if (instr == PPU_instr::implicts::BLR()) {
+			after_return = true;
+		}
+		else if (PPU_instr::fields::OPCD(instr) == PPU_opcodes::PPU_MainOpcodes::B && PPU_instr::fields::LK(instr)) {
+			u32 target = SignExt26(PPU_instr::fields::LL(instr));
+			if (!PPU_instr::fields::AA(instr)) // Absolute address
+				target += instructionAddress;
+
+			if (target >= address && target < address + size)
+				entries.insert(target);
+		}
+	}
+
+	return{ entries.begin(), entries.end() };
+}
+
+void RecompilationEngine::PrecompileRange(u32 address, u32 size) {
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	// Blocks are grouped in modules of this size, each module is compiled by a single worker
+	const size_t blocks_per_module = 512;
+
+	std::vector<std::vector<BlockEntry>> batches;
+	u32 discovered = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_compile_lock);
+
+		for (u32 entry : DiscoverFunctions(address, size)) {
+			discovered++;
+
+			auto found = m_block_table.find(entry);
+			if (found != m_block_table.end() && found->second.is_analysed)
+				continue;
+
+			BlockEntry block(entry);
+
+			// Code without a clear return semantic is left to the hit-counting JIT
+			if (!AnalyseBlock(block, std::min<size_t>(10000, address + size - entry)) || !block.is_compilable_function)
+				continue;
+
+			if (batches.empty() || batches.back().size() >= blocks_per_module)
+				batches.emplace_back();
+
+			batches.back().push_back(std::move(block));
+		}
+	}
+
+	if (batches.empty()) {
+		LOG_NOTICE(PPU, "LLVM AOT: nothing to compile in 0x%x..0x%x (%u entries discovered)", address, address + size, discovered);
+		return;
+	}
+
+	std::vector<std::pair<std::vector<Executable>, llvm::ExecutionEngine *>> results(batches.size());
+	std::vector<std::unique_ptr<llvm::LLVMContext>> contexts(batches.size());
+	std::atomic<size_t> next_batch{ 0 };
+
+	auto worker = [&]() {
+		for (size_t i; (i = next_batch++) < batches.size();) {
+			contexts[i].reset(new llvm::LLVMContext());
+			results[i] = compile_batch(*contexts[i], batches[i]);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	const size_t worker_count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), batches.size());
+
+	for (size_t i = 1; i < worker_count; i++) {
+		workers.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto & thread : workers) {
+		thread.join();
+	}
+
+	u32 compiled = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_compile_lock);
+
+		for (size_t i = 0; i < batches.size(); i++) {
+			m_aot_contexts.push_back(std::move(contexts[i]));
+			m_executable_storage.push_back(std::unique_ptr<llvm::ExecutionEngine>(results[i].second));
+
+			for (size_t j = 0; j < batches[i].size(); j++) {
+				BlockEntry & block = batches[i][j];
+				block.is_compiled = true;
+
+				PublishExecutable(block.address, block.instructionCount * 4, results[i].first[j]);
+				m_block_table.erase(block.address);
+				m_block_table.emplace(block.address, std::move(block));
+				compiled++;
+			}
+		}
+
+		// Drop functions whose code was modified during compilation
+		ProcessInvalidations();
+	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+	LOG_SUCCESS(PPU, "LLVM AOT: compiled %u of %u discovered functions in 0x%x..0x%x (%u modules, %u threads, %lld ms)",
+		compiled, discovered, address, address + size, size32(batches), (u32)worker_count, elapsed.count());
+}
+
 std::shared_ptr<RecompilationEngine> RecompilationEngine::GetInstance() {
 	std::lock_guard<std::mutex> lock(s_mutex);
 
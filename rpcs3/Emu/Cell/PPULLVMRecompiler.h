@@ -755,6 +755,16 @@ namespace ppu_recompiler_llvm {
 		/// Notify the recompilation engine about a newly detected block start.
 		void NotifyBlockStart(u32 address);
 
+		/**
+		 * Discover the functions of an executable area and compile them ahead of time.
+		 * Functions are compiled in parallel into a few large modules and published
+		 * in FunctionCache before returning.
+		 **/
+		void PrecompileRange(u32 address, u32 size);
+
+		/// Queue an executable area to be compiled ahead of time by the recompilation engine thread.
+		void QueuePrecompileRange(u32 address, u32 size);
+
 		/// Log
 		llvm::raw_fd_ostream & Log();
 
@@ -818,6 +828,9 @@ namespace ppu_recompiler_llvm {
 		/// Queue of block start address to process
 		std::list<u32> m_pending_address_start;
 
+		/// Queue of executable areas (address, size) to compile ahead of time, protected by m_pending_address_start_lock
+		std::vector<std::pair<u32, u32> > m_pending_precompile;
+
 		/// Block table
 		std::unordered_map<u32, BlockEntry> m_block_table;
 
@@ -841,6 +854,18 @@ namespace ppu_recompiler_llvm {
 		/// vector storing all exec engine
 		std::vector<std::unique_ptr<llvm::ExecutionEngine> > m_executable_storage;
 
+		/// LLVM contexts owning the modules compiled ahead of time (one per module)
+		std::vector<std::unique_ptr<llvm::LLVMContext> > m_aot_contexts;
+
+		/// Lock for accessing m_block_table, FunctionCache and m_executable_storage
+		std::mutex m_compile_lock;
+
+		/// Lock for accessing m_pending_invalidations
+		std::mutex m_pending_invalidations_lock;
+
+		/// Modified memory areas (address, size) whose blocks must be removed from m_block_table
+		std::vector<std::pair<u32, u32> > m_pending_invalidations;
+
 
 		/// LLVM context
 		llvm::LLVMContext &m_llvm_context;
@@ -854,6 +879,18 @@ namespace ppu_recompiler_llvm {
 		*/
 		std::pair<Executable, llvm::ExecutionEngine *> compile(const std::string & name, u32 start_address, u32 instruction_count);
 
+		/**
+		* Compile several analysed blocks into a single module using the given context.
+		* Returns executables in the same order as blocks. Safe to call from multiple threads with distinct contexts.
+		*/
+		std::pair<std::vector<Executable>, llvm::ExecutionEngine *> compile_batch(llvm::LLVMContext & context, const std::vector<BlockEntry> & blocks);
+
+		/// Fill the map of external symbols available to compiled code
+		static void InitFunctionPtrs(std::unordered_map<std::string, void*> & function_ptrs);
+
+		/// Create an execution engine for a module and translate it to machine code
+		static llvm::ExecutionEngine * CreateExecutionEngine(std::unique_ptr<llvm::Module> module, std::unordered_map<std::string, void*> & function_ptrs);
+
 		/// The time at which the m_address_to_ordinal cache was last cleared
 		std::chrono::high_resolution_clock::time_point m_last_cache_clear_time;
 
@@ -875,6 +912,22 @@ namespace ppu_recompiler_llvm {
 		/// Compile a block
 		void CompileBlock(BlockEntry & block_entry);
 
+		/// Find function entry candidates in an executable area (call targets and code following a return)
+		std::vector<u32> DiscoverFunctions(u32 address, u32 size) const;
+
+		/// Store a compiled executable for address in FunctionCache and write-protect its code
+		void PublishExecutable(u32 address, u32 size, Executable executable);
+
+		/**
+		 * Called by the vm code watcher when guest code is modified or unmapped.
+		 * Executables starting in the area are removed from FunctionCache immediately,
+		 * overlapping blocks are removed later by ProcessInvalidations.
+		 **/
+		void InvalidateRange(u32 address, u32 size);
+
+		/// Remove blocks overlapping modified areas from m_block_table (m_compile_lock must be held)
+		void ProcessInvalidations();
+
 		/// Mutex used to prevent multiple creation
 		static std::mutex s_mutex;
 
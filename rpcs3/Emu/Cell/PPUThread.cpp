@@ -26,33 +26,135 @@ extern void ppu_free_tls(u32 thread);
 //thread_local const std::weak_ptr<ppu_decoder_cache_t> g_tls_ppu_decoder_cache = fxm::get<ppu_decoder_cache_t>();
 thread_local const ppu_decoder_cache_t* g_tls_ppu_decoder_cache = nullptr; // temporarily, because thread_local is not fully available
 
+// Placeholder for invalidated functions: decode the page again and execute the instruction
+static void ppu_decoder_refresh(PPUThread& ppu, ppu_opcode_t op)
+{
+	const auto decoder_cache = fxm::get<ppu_decoder_cache_t>();
+
+	if (!decoder_cache)
+	{
+		throw EXCEPTION("PPU Decoder Cache not initialized");
+	}
+
+	decoder_cache->initialize(ppu.PC & ~0xfff, 4096);
+
+	decoder_cache->pointer[ppu.PC / 4](ppu, op);
+}
+
+// Placeholder for functions in frequently modified pages: decode the instruction on every execution
+static void ppu_decoder_uncached(PPUThread& ppu, ppu_opcode_t op)
+{
+	PPUInterpreter2* inter;
+	PPUDecoder dec(inter = new PPUInterpreter2);
+
+	inter->func = ppu_interpreter::NULL_OP;
+
+	dec.Decode(op.opcode);
+
+	inter->func(ppu, op);
+}
+
+// Number of invalidations after which the page is no longer write-protected
+const u8 g_ppu_max_code_writes = 8;
+
 ppu_decoder_cache_t::ppu_decoder_cache_t()
 	: pointer(static_cast<decltype(pointer)>(memory_helper::reserve_memory(0x200000000)))
+	, pages(new atomic_t<u8>[0x100000]{})
+	, writes(new atomic_t<u8>[0x100000]{})
 {
+	vm::add_code_watcher(this, [this](u32 addr, u32 size)
+	{
+		invalidate(addr, size);
+	});
 }
 
 ppu_decoder_cache_t::~ppu_decoder_cache_t()
 {
+	vm::remove_code_watcher(this);
+
 	memory_helper::free_reserved_memory(pointer, 0x200000000);
 }
 
 void ppu_decoder_cache_t::initialize(u32 addr, u32 size)
 {
-	memory_helper::commit_page_memory(pointer + addr / 4, size * 2);
+	if (!size)
+	{
+		return;
+	}
+
+	const u32 page = addr & ~0xfff;
+	const u32 page_size = align(addr + size, 4096) - page;
+
+	memory_helper::commit_page_memory(pointer + page / 4, page_size * 2);
 
 	PPUInterpreter2* inter;
 	PPUDecoder dec(inter = new PPUInterpreter2);
 
-	for (u32 pos = addr; pos < addr + size; pos += 4)
+	for (u32 i = page / 4096; i < page / 4096 + page_size / 4096; i++)
+	{
+		const u32 start = std::max<u32>(addr, i * 4096);
+		const u32 end = std::min<u64>(u64{ addr } + size, (i + 1ull) * 4096) - 1;
+
+		if (writes[i] >= g_ppu_max_code_writes)
+		{
+			// avoid write faults in pages which are mostly data or constantly patched
+			std::fill(pointer + start / 4, pointer + end / 4 + 1, &ppu_decoder_uncached);
+			continue;
+		}
+
+		// write-protect the code before decoding, modification will trigger invalidate()
+		vm::watch_code(i * 4096, 4096);
+
+		for (u32 pos = start; pos < end; pos += 4)
+		{
+			inter->func = ppu_interpreter::NULL_OP;
+
+			// decode PPU opcode
+			dec.Decode(vm::ps3::read32(pos));
+
+			// store function address
+			pointer[pos / 4] = inter->func;
+		}
+
+		pages[i] = 1;
+	}
+}
+
+void ppu_decoder_cache_t::invalidate(u32 addr, u32 size)
+{
+	for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
 	{
-		inter->func = ppu_interpreter::NULL_OP;
+		// only decoded pages have committed memory
+		if (pages[i].exchange(0))
+		{
+			std::fill_n(pointer + i * 1024, 1024, &ppu_decoder_refresh);
 
-		// decode PPU opcode
-		dec.Decode(vm::ps3::read32(pos));
+			if (writes[i] < g_ppu_max_code_writes)
+			{
+				writes[i]++;
+			}
+		}
+	}
+}
 
-		// store function address
-		pointer[pos / 4] = inter->func;
+// Compile executable area ahead of time (if async is set, the area is queued to the recompilation engine thread)
+void ppu_precompile(u32 addr, u32 size, bool async)
+{
+	if (rpcs3::state.config.core.ppu_decoder.value() != ppu_decoder_type::recompiler_llvm || !rpcs3::state.config.core.llvm.aot.value())
+	{
+		return;
 	}
+
+#ifdef PPU_LLVM_RECOMPILER
+	if (async)
+	{
+		ppu_recompiler_llvm::RecompilationEngine::GetInstance()->QueuePrecompileRange(addr, size);
+	}
+	else
+	{
+		ppu_recompiler_llvm::RecompilationEngine::GetInstance()->PrecompileRange(addr, size);
+	}
+#endif
 }
 
 PPUThread::PPUThread(const std::string& name)
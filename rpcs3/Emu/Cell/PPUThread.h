@@ -547,6 +547,7 @@ public:
 	virtual void dump_info() const override;
 	virtual u32 get_pc() const override { return PC; }
 	virtual u32 get_offset() const override { return 0; }
+	virtual s32 get_prio() const override { return prio; }
 	virtual void do_run() override;
 	virtual void cpu_task() override;
 
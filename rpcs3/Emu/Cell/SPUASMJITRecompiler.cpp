@@ -15,11 +15,37 @@
 
 #include "asmjit.h"
 
-#define SPU_OFF_128(x) asmjit::host::oword_ptr(*cpu, OFFSET_32(SPUThread, x))
-#define SPU_OFF_64(x) asmjit::host::qword_ptr(*cpu, OFFSET_32(SPUThread, x))
-#define SPU_OFF_32(x) asmjit::host::dword_ptr(*cpu, OFFSET_32(SPUThread, x))
-#define SPU_OFF_16(x) asmjit::host::word_ptr(*cpu, OFFSET_32(SPUThread, x))
-#define SPU_OFF_8(x) asmjit::host::byte_ptr(*cpu, OFFSET_32(SPUThread, x))
+// Direct access to SPUThread members (writes back and drops cached SPU registers in the accessed range)
+#define SPU_OFF_128(x) asmjit::host::oword_ptr(*cpu, XmmSync(OFFSET_32(SPUThread, x), 16))
+#define SPU_OFF_64(x) asmjit::host::qword_ptr(*cpu, XmmSync(OFFSET_32(SPUThread, x), 8))
+#define SPU_OFF_32(x) asmjit::host::dword_ptr(*cpu, XmmSync(OFFSET_32(SPUThread, x), 4))
+#define SPU_OFF_16(x) asmjit::host::word_ptr(*cpu, XmmSync(OFFSET_32(SPUThread, x), 2))
+#define SPU_OFF_8(x) asmjit::host::byte_ptr(*cpu, XmmSync(OFFSET_32(SPUThread, x), 1))
+
+// SPU register in memory (for the register cache only)
+#define SPU_GPR_128(reg) asmjit::host::oword_ptr(*cpu, OFFSET_32(SPUThread, gpr[0]) + (reg) * 16)
+
+// Check whether the instruction may jump, call or access SPU registers from outside of compiled code
+static bool spu_is_block_exit(spu_itype_t type)
+{
+	using namespace spu_itype;
+
+	switch (type)
+	{
+	case BR: case BRA: case BRSL: case BRASL:
+	case BI: case BISL: case BISLED: case IRET:
+	case BIZ: case BINZ: case BIHZ: case BIHNZ:
+	case BRZ: case BRNZ: case BRHZ: case BRHNZ:
+	case HEQ: case HEQI: case HGT: case HGTI: case HLGT: case HLGTI:
+	case STOP: case STOPD: case RDCH: case WRCH: case RCHCNT:
+	case UNK:
+	{
+		return true;
+	}
+	}
+
+	return false;
+}
 
 spu_recompiler::spu_recompiler()
 	: m_jit(std::make_shared<asmjit::JitRuntime>())
@@ -27,7 +53,9 @@ spu_recompiler::spu_recompiler()
 	asmjit::X86CpuInfo inf;
 	asmjit::X86CpuUtil::detect(&inf);
 
-	LOG_SUCCESS(SPU, "SPU Recompiler (ASMJIT) created...");
+	m_avx = inf.hasFeature(asmjit::kX86CpuFeatureAVX);
+
+	LOG_SUCCESS(SPU, "SPU Recompiler (ASMJIT) created (AVX: %s)", m_avx ? "yes" : "no");
 
 	fs::file(fs::get_config_dir() + "SPUJIT.log", fom::rewrite).write(fmt::format("SPU JIT initialization...\n\nTitle: %s\nTitle ID: %s\n\n", Emu.GetTitle().c_str(), Emu.GetTitleID().c_str()));
 }
@@ -36,7 +64,7 @@ void spu_recompiler::compile(spu_function_t& f)
 {
 	std::lock_guard<std::mutex> lock(m_mutex);
 
-	if (f.compiled)
+	if (f.compiled.load())
 	{
 		// return if function already compiled
 		return;
@@ -93,6 +121,19 @@ void spu_recompiler::compile(spu_function_t& f)
 		vec.at(i) = vec_vars.data() + i;
 	}
 
+	// Initialize register cache (SPU registers are kept in xmm vars within basic blocks)
+	std::array<X86XmmVar, 128> gpr_vars;
+
+	for (u32 i = 0; i < gpr_vars.size(); i++)
+	{
+		gpr_vars[i] = X86XmmVar{ compiler, kX86VarTypeXmm, fmt::format("gpr%d", i).c_str() };
+	}
+
+	this->m_gpr_vars = gpr_vars.data();
+	m_gpr_cache.fill(nullptr);
+	m_gpr_dirty.fill(false);
+	m_gpr_loads = m_gpr_reads = m_gpr_stores = m_gpr_writes = 0;
+
 	// Initialize labels
 	std::vector<Label> pos_labels{ 0x10000 };
 	this->labels = pos_labels.data();
@@ -132,6 +173,14 @@ void spu_recompiler::compile(spu_function_t& f)
 
 	for (const u32 op : f.data)
 	{
+		const spu_itype_t type = g_spu_itype[op];
+
+		// Write back cached registers at block entries and before instructions which may leave the block
+		if (pos_labels[m_pos / 4].isInitialized() || spu_is_block_exit(type))
+		{
+			XmmFlush();
+		}
+
 		// Bind label if initialized
 		if (pos_labels[m_pos / 4].isInitialized())
 		{
@@ -141,6 +190,9 @@ void spu_recompiler::compile(spu_function_t& f)
 			{
 				compiler.addComment("Block:");
 			}
+
+			// loops inside the function don't return to the dispatcher
+			CheckSchedule();
 		}
 
 		// Disasm
@@ -167,7 +219,10 @@ void spu_recompiler::compile(spu_function_t& f)
 		m_pos += 4;
 	}
 
-	log += '\n';
+	XmmFlush();
+
+	// Memory accesses emitted / SPU register accesses
+	log += fmt::format("\nRegister cache: %u/%u loads, %u/%u stores\n\n", m_gpr_loads, m_gpr_reads, m_gpr_stores, m_gpr_writes);
 
 	// Generate default function end (go to the next address)
 	compiler.bind(pos_labels[m_pos / 4 % 0x10000]);
@@ -183,13 +238,14 @@ void spu_recompiler::compile(spu_function_t& f)
 		compiler.addComment("Jump table resolver:");
 	}
 
+	// Valid entries (sorted)
+	std::vector<u32> jt_entries;
+
 	for (const u32 addr : f.jtable)
 	{
 		if ((addr % 4) == 0 && addr < 0x40000 && pos_labels[addr / 4].isInitialized())
 		{
-			// It could be binary search or something
-			compiler.cmp(addr_var, addr);
-			compiler.je(pos_labels[addr / 4]);
+			jt_entries.emplace_back(addr);
 		}
 		else
 		{
@@ -197,6 +253,35 @@ void spu_recompiler::compile(spu_function_t& f)
 		}
 	}
 
+	// Emit binary search over jt_entries[first, last), unknown targets go to the function end
+	std::function<void(std::size_t, std::size_t)> emit_search = [&](std::size_t first, std::size_t last)
+	{
+		if (last - first <= 4)
+		{
+			// Linear search is faster for a few entries
+			for (std::size_t i = first; i < last; i++)
+			{
+				compiler.cmp(addr_var, jt_entries[i]);
+				compiler.je(pos_labels[jt_entries[i] / 4]);
+			}
+
+			compiler.jmp(end_label);
+			return;
+		}
+
+		const std::size_t mid = (first + last) / 2;
+
+		Label upper = compiler.newLabel();
+		compiler.cmp(addr_var, jt_entries[mid]);
+		compiler.je(pos_labels[jt_entries[mid] / 4]);
+		compiler.ja(upper);
+		emit_search(first, mid);
+		compiler.bind(upper);
+		emit_search(mid + 1, last);
+	};
+
+	emit_search(0, jt_entries.size());
+
 	// Generate function end (returns addr_var)
 	compiler.bind(end_label);
 	compiler.unuse(cpu_var);
@@ -206,8 +291,12 @@ void spu_recompiler::compile(spu_function_t& f)
 	// Finalization
 	compiler.endFunc();
 
-	// Compile and store function address
-	f.compiled = asmjit_cast<spu_jit_func_t>(compiler.make());
+	// Compile function
+	const auto compiled = asmjit_cast<spu_jit_func_t>(compiler.make());
+
+	// Publish function address (other threads may read it without locking)
+	std::atomic_thread_fence(std::memory_order_release);
+	f.compiled.store(compiled);
 
 	// Add ASMJIT logs
 	log += logger.getString();
@@ -231,17 +320,94 @@ spu_recompiler::XmmLink spu_recompiler::XmmGet(s8 reg, XmmType type) // get xmm
 {
 	XmmLink result = XmmAlloc();
 
+	if (!m_gpr_cache[reg])
+	{
+		// load SPU register into the cache
+		m_gpr_cache[reg] = m_gpr_vars + reg;
+		m_gpr_loads++;
+
+		switch (type)
+		{
+		case XmmType::Int: c->movdqa(*m_gpr_cache[reg], SPU_GPR_128(reg)); break;
+		case XmmType::Float: c->movaps(*m_gpr_cache[reg], SPU_GPR_128(reg)); break;
+		case XmmType::Double: c->movapd(*m_gpr_cache[reg], SPU_GPR_128(reg)); break;
+		default: throw EXCEPTION("Invalid XmmType");
+		}
+	}
+
+	m_gpr_reads++;
+
 	switch (type)
 	{
-	case XmmType::Int: c->movdqa(result, SPU_OFF_128(gpr[reg])); break;
-	case XmmType::Float: c->movaps(result, SPU_OFF_128(gpr[reg])); break;
-	case XmmType::Double: c->movapd(result, SPU_OFF_128(gpr[reg])); break;
+	case XmmType::Int: c->movdqa(result, *m_gpr_cache[reg]); break;
+	case XmmType::Float: c->movaps(result, *m_gpr_cache[reg]); break;
+	case XmmType::Double: c->movapd(result, *m_gpr_cache[reg]); break;
 	default: throw EXCEPTION("Invalid XmmType");
 	}
 
 	return result;
 }
 
+asmjit::X86XmmVar& spu_recompiler::XmmRead(s8 reg) // get cached SPU reg itself (must not be modified, only for source operands)
+{
+	if (!m_gpr_cache[reg])
+	{
+		m_gpr_cache[reg] = m_gpr_vars + reg;
+		m_gpr_loads++;
+
+		c->movdqa(*m_gpr_cache[reg], SPU_GPR_128(reg));
+	}
+
+	m_gpr_reads++;
+
+	return *m_gpr_cache[reg];
+}
+
+void spu_recompiler::XmmSet(s8 reg, asmjit::X86XmmVar& value) // set SPU reg (written back later)
+{
+	m_gpr_cache[reg] = m_gpr_vars + reg;
+	m_gpr_dirty[reg] = true;
+	m_gpr_writes++;
+
+	c->movdqa(*m_gpr_cache[reg], value);
+}
+
+void spu_recompiler::XmmFlush(u32 first, u32 last) // write back and drop cached SPU regs [first, last)
+{
+	for (u32 reg = first; reg < last; reg++)
+	{
+		if (!m_gpr_cache[reg])
+		{
+			continue;
+		}
+
+		if (m_gpr_dirty[reg])
+		{
+			c->movdqa(SPU_GPR_128(reg), *m_gpr_cache[reg]);
+			m_gpr_dirty[reg] = false;
+			m_gpr_stores++;
+		}
+
+		c->unuse(*m_gpr_cache[reg]);
+		m_gpr_cache[reg] = nullptr;
+	}
+}
+
+u32 spu_recompiler::XmmSync(u32 offset, u32 size)
+{
+	const u32 gpr_offset = OFFSET_32(SPUThread, gpr[0]);
+
+	if (offset + size > gpr_offset && offset < gpr_offset + 128 * 16)
+	{
+		const u32 first = offset > gpr_offset ? (offset - gpr_offset) / 16 : 0;
+		const u32 last = std::min<u32>((offset + size - gpr_offset + 15) / 16, 128);
+
+		XmmFlush(first, last);
+	}
+
+	return offset;
+}
+
 inline asmjit::X86Mem spu_recompiler::XmmConst(v128 data)
 {
 	return c->newXmmConst(asmjit::kConstScopeLocal, asmjit::Vec128::fromUq(data._u64[0], data._u64[1]));
@@ -290,6 +456,8 @@ void spu_recompiler::InterpreterCall(spu_opcode_t op)
 		}
 	};
 
+	XmmFlush();
+
 	c->mov(SPU_OFF_32(pc), m_pos);
 	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32, spu_inter_func_t)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder3<u32, void*, u32, void*>());
 	call->setArg(0, *cpu);
@@ -338,22 +506,12 @@ void spu_recompiler::FunctionCall()
 				LOG_ERROR(SPU, "Branch-to-self");
 			}
 
-			while (!_spu->m_state || !_spu->check_status())
+			// Call override function directly since the type is known
+			if (static_cast<SPURecompilerDecoder&>(*_spu->m_dec).call(link) == link)
 			{
-				// Call override function directly since the type is known
-				static_cast<SPURecompilerDecoder&>(*_spu->m_dec).DecodeMemory(_spu->offset + _spu->pc);
-
-				if (_spu->m_state & CPU_STATE_RETURN)
-				{
-					break;
-				}
-
-				if (_spu->pc == link)
-				{
-					// returned successfully
-					_spu->recursion_level--;
-					return 0;
-				}
+				// returned successfully
+				_spu->recursion_level--;
+				return 0;
 			}
 
 			_spu->recursion_level--;
@@ -368,6 +526,8 @@ void spu_recompiler::FunctionCall()
 		}
 	};
 
+	XmmFlush();
+
 	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder2<u32, SPUThread*, u32>());
 	call->setArg(0, *cpu);
 	call->setArg(1, asmjit::imm_u(spu_branch_target(m_pos + 4)));
@@ -379,6 +539,71 @@ void spu_recompiler::FunctionCall()
 	c->unuse(*addr);
 }
 
+void spu_recompiler::CheckSchedule()
+{
+	auto gate = [](SPUThread* _spu) noexcept -> u32
+	{
+		try
+		{
+			if (_spu->sched)
+			{
+				_spu->sched_check();
+			}
+
+			return 0;
+		}
+		catch (...)
+		{
+			_spu->pending_exception = std::current_exception();
+			return 0x1000000 | _spu->pc;
+		}
+	};
+
+	asmjit::Label next = c->newLabel();
+	c->sub(SPU_OFF_32(sched_budget), 1);
+	c->jnz(next);
+	c->mov(SPU_OFF_32(pc), m_pos);
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder1<u32, void*>());
+	call->setArg(0, *cpu);
+	call->setRet(0, *addr);
+
+	// return immediately if an error occured
+	c->test(*addr, *addr);
+	c->jnz(*end);
+	c->unuse(*addr);
+	c->bind(next);
+}
+
+void spu_recompiler::SetScalar(s8 reg, asmjit::X86GpVar& value)
+{
+	// Set preferred slot, clear other elements (stored to memory because it may be used on conditional paths)
+	const XmmLink& vr = XmmAlloc();
+	c->movd(vr, value.r32());
+	c->pslldq(vr, 12);
+	c->movdqa(SPU_OFF_128(gpr[reg]), vr);
+}
+
+void spu_recompiler::CheckCodeStore()
+{
+	// test the bit of 128-byte line in ls_code_map
+	asmjit::Label skip = c->newLabel();
+	c->mov(qw0->r32(), *addr);
+	c->shr(qw0->r32(), 7);
+	c->bt(SPU_OFF_32(ls_code_map), qw0->r32());
+	c->jnc(skip);
+	c->mov(SPU_OFF_32(ls_code_dirty), 1);
+	c->bind(skip);
+}
+
+void spu_recompiler::CheckCodeStore(u32 lsa)
+{
+	asmjit::Label skip = c->newLabel();
+	c->test(asmjit::host::byte_ptr(*cpu, OFFSET_32(SPUThread, ls_code_map) + lsa / 128 / 8), 1 << (lsa / 128 % 8));
+	c->jz(skip);
+	c->mov(SPU_OFF_32(ls_code_dirty), 1);
+	c->bind(skip);
+}
+
 void spu_recompiler::STOP(spu_opcode_t op)
 {
 	InterpreterCall(op); // TODO
@@ -402,32 +627,138 @@ void spu_recompiler::DSYNC(spu_opcode_t op)
 
 void spu_recompiler::MFSPR(spu_opcode_t op)
 {
-	InterpreterCall(op);
+	// All SPRs read as zero (see interpreter)
+	const XmmLink& vr = XmmAlloc();
+	c->pxor(vr, vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::RDCH(spu_opcode_t op)
 {
-	InterpreterCall(op); // TODO
+	switch (op.ra)
+	{
+	case MFC_RdTagMask:
+	{
+		c->mov(qw0->r32(), SPU_OFF_32(ch_tag_mask));
+		SetScalar(op.rt, *qw0);
+		return;
+	}
+
+	case SPU_RdEventMask:
+	{
+		c->mov(qw0->r32(), SPU_OFF_32(ch_event_mask));
+		SetScalar(op.rt, *qw0);
+		return;
+	}
+
+	case SPU_RdInMbox:
+	case MFC_RdTagStat:
+	case SPU_RdSigNotify1:
+	case SPU_RdSigNotify2:
+	case MFC_RdAtomicStat:
+	case MFC_RdListStallStat:
+	case SPU_RdDec:
+	case SPU_RdEventStat:
+	case SPU_RdMachStat:
+	{
+		break;
+	}
+
+	default:
+	{
+		InterpreterCall(op);
+		return;
+	}
+	}
+
+	// Try to read the channel without waiting, call the interpreter otherwise
+	auto gate = [](SPUThread* _spu, u32 ch) noexcept -> u64
+	{
+		try
+		{
+			// channel polling loops may be never interrupted otherwise (checked first, the value can't be lost)
+			if (_spu->sched && !--_spu->sched_budget)
+			{
+				_spu->sched_check();
+			}
+
+			u32 value;
+			return _spu->try_get_ch_value(ch, value) ? 1ull << 32 | value : 0;
+		}
+		catch (...)
+		{
+			return 0;
+		}
+	};
+
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u64(SPUThread*, u32)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder2<u64, void*, u32>());
+	call->setArg(0, *cpu);
+	call->setArg(1, asmjit::imm_u(op.ra));
+	call->setRet(0, *qw0);
+
+	asmjit::Label slow = c->newLabel();
+	asmjit::Label done = c->newLabel();
+	c->bt(*qw0, 32);
+	c->jnc(slow);
+	SetScalar(op.rt, *qw0);
+	c->jmp(done);
+	c->bind(slow);
+	InterpreterCall(op);
+	c->bind(done);
 }
 
 void spu_recompiler::RCHCNT(spu_opcode_t op)
 {
-	InterpreterCall(op); // TODO
+	switch (op.ra)
+	{
+	case SPU_WrOutMbox:
+	case SPU_WrOutIntrMbox:
+	case SPU_RdInMbox:
+	case MFC_RdTagStat:
+	case MFC_RdListStallStat:
+	case MFC_WrTagUpdate:
+	case SPU_RdSigNotify1:
+	case SPU_RdSigNotify2:
+	case MFC_RdAtomicStat:
+	case SPU_RdEventStat:
+	{
+		break;
+	}
+
+	default:
+	{
+		InterpreterCall(op);
+		return;
+	}
+	}
+
+	// Channel counts never block
+	auto gate = [](SPUThread* _spu, u32 ch) noexcept -> u32
+	{
+		return _spu->get_ch_count(ch);
+	};
+
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder2<u32, void*, u32>());
+	call->setArg(0, *cpu);
+	call->setArg(1, asmjit::imm_u(op.ra));
+	call->setRet(0, *qw0);
+
+	SetScalar(op.rt, *qw0);
 }
 
 void spu_recompiler::SF(spu_opcode_t op)
 {
 	// sub from
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->psubd(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->psubd(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::OR(spu_opcode_t op)
 {
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->por(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->por(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::BG(spu_opcode_t op)
@@ -437,26 +768,26 @@ void spu_recompiler::BG(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movdqa(vi, XmmConst(_mm_set1_epi32(0x80000000)));
 	c->pxor(va, vi);
-	c->pxor(vi, SPU_OFF_128(gpr[op.rb]));
+	c->pxor(vi, XmmRead(op.rb));
 	c->pcmpgtd(va, vi);
 	c->paddd(va, XmmConst(_mm_set1_epi32(1)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SFH(spu_opcode_t op)
 {
 	// sub from (halfword)
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->psubw(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->psubw(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::NOR(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->por(va, SPU_OFF_128(gpr[op.rb]));
+	c->por(va, XmmRead(op.rb));
 	c->pxor(va, XmmConst(_mm_set1_epi32(0xffffffff)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ABSDB(spu_opcode_t op)
@@ -468,7 +799,7 @@ void spu_recompiler::ABSDB(spu_opcode_t op)
 	c->pmaxub(va, vb);
 	c->pminub(vb, vm);
 	c->psubb(va, vb);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROT(spu_opcode_t op)
@@ -701,7 +1032,7 @@ void spu_recompiler::ROTI(spu_opcode_t op)
 	c->pslld(va, s);
 	c->psrld(v1, 32 - s);
 	c->por(va, v1);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTMI(spu_opcode_t op)
@@ -710,7 +1041,7 @@ void spu_recompiler::ROTMI(spu_opcode_t op)
 	const int s = 0-op.i7 & 0x3f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psrld(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTMAI(spu_opcode_t op)
@@ -719,7 +1050,7 @@ void spu_recompiler::ROTMAI(spu_opcode_t op)
 	const int s = 0-op.i7 & 0x3f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psrad(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SHLI(spu_opcode_t op)
@@ -728,7 +1059,7 @@ void spu_recompiler::SHLI(spu_opcode_t op)
 	const int s = op.i7 & 0x3f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pslld(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTHI(spu_opcode_t op)
@@ -741,7 +1072,7 @@ void spu_recompiler::ROTHI(spu_opcode_t op)
 	c->psllw(va, s);
 	c->psrlw(v1, 16 - s);
 	c->por(va, v1);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTHMI(spu_opcode_t op)
@@ -750,7 +1081,7 @@ void spu_recompiler::ROTHMI(spu_opcode_t op)
 	const int s = 0-op.i7 & 0x1f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psrlw(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTMAHI(spu_opcode_t op)
@@ -759,7 +1090,7 @@ void spu_recompiler::ROTMAHI(spu_opcode_t op)
 	const int s = 0-op.i7 & 0x1f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psraw(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SHLHI(spu_opcode_t op)
@@ -768,22 +1099,22 @@ void spu_recompiler::SHLHI(spu_opcode_t op)
 	const int s = op.i7 & 0x1f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psllw(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::A(spu_opcode_t op)
 {
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->paddd(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->paddd(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::AND(spu_opcode_t op)
 {
 	// and
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->pand(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->pand(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::CG(spu_opcode_t op)
@@ -797,40 +1128,137 @@ void spu_recompiler::CG(spu_opcode_t op)
 	c->pxor(vb, vi);
 	c->pcmpgtd(va, vb);
 	c->psrld(va, 31);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::AH(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->paddw(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->paddw(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::NAND(spu_opcode_t op)
 {
 	// nand
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pand(va, SPU_OFF_128(gpr[op.rb]));
+	c->pand(va, XmmRead(op.rb));
 	c->pxor(va, XmmConst(_mm_set1_epi32(0xffffffff)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::AVGB(spu_opcode_t op)
 {
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->pavgb(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->pavgb(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::MTSPR(spu_opcode_t op)
 {
-	InterpreterCall(op);
+	// SPR writes are ignored (see interpreter)
 }
 
 void spu_recompiler::WRCH(spu_opcode_t op)
 {
-	InterpreterCall(op); // TODO
+	switch (op.ra)
+	{
+	case MFC_EAH:
+	{
+		c->mov(qw0->r32(), SPU_OFF_32(gpr[op.rt]._u32[3]));
+		c->mov(SPU_OFF_32(ch_mfc_args.eah), qw0->r32());
+		return;
+	}
+
+	case MFC_EAL:
+	{
+		c->mov(qw0->r32(), SPU_OFF_32(gpr[op.rt]._u32[3]));
+		c->mov(SPU_OFF_32(ch_mfc_args.eal), qw0->r32());
+		return;
+	}
+
+	case MFC_WrTagMask:
+	{
+		c->mov(qw0->r32(), SPU_OFF_32(gpr[op.rt]._u32[3]));
+		c->mov(SPU_OFF_32(ch_tag_mask), qw0->r32());
+		return;
+	}
+
+	case MFC_LSA:
+	case MFC_Size:
+	case MFC_TagID:
+	{
+		// Store the value if it's valid, call the interpreter otherwise
+		asmjit::Label slow = c->newLabel();
+		asmjit::Label done = c->newLabel();
+		c->mov(qw0->r32(), SPU_OFF_32(gpr[op.rt]._u32[3]));
+		c->cmp(qw0->r32(), op.ra == MFC_LSA ? 0x40000 : op.ra == MFC_Size ? 16 * 1024 + 1 : 32);
+		c->jae(slow);
+
+		if (op.ra == MFC_LSA)
+		{
+			c->mov(SPU_OFF_32(ch_mfc_args.lsa), qw0->r32());
+		}
+		else if (op.ra == MFC_Size)
+		{
+			c->mov(SPU_OFF_16(ch_mfc_args.size), qw0->r16());
+		}
+		else
+		{
+			c->mov(SPU_OFF_16(ch_mfc_args.tag), qw0->r16());
+		}
+
+		c->jmp(done);
+		c->bind(slow);
+		InterpreterCall(op);
+		c->bind(done);
+		return;
+	}
+
+	case SPU_WrOutMbox:
+	case MFC_WrTagUpdate:
+	case SPU_WrDec:
+	{
+		break;
+	}
+
+	default:
+	{
+		InterpreterCall(op);
+		return;
+	}
+	}
+
+	// Try to write the channel without waiting, call the interpreter otherwise
+	auto gate = [](SPUThread* _spu, u32 ch, u32 value) noexcept -> u32
+	{
+		try
+		{
+			if (_spu->sched && !--_spu->sched_budget)
+			{
+				_spu->sched_check();
+			}
+
+			return _spu->try_set_ch_value(ch, value);
+		}
+		catch (...)
+		{
+			return 0;
+		}
+	};
+
+	c->mov(qw0->r32(), SPU_OFF_32(gpr[op.rt]._u32[3]));
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32, u32)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder3<u32, void*, u32, u32>());
+	call->setArg(0, *cpu);
+	call->setArg(1, asmjit::imm_u(op.ra));
+	call->setArg(2, *qw0);
+	call->setRet(0, *qw0);
+
+	asmjit::Label done = c->newLabel();
+	c->test(qw0->r32(), qw0->r32());
+	c->jnz(done);
+	InterpreterCall(op);
+	c->bind(done);
 }
 
 void spu_recompiler::BIZ(spu_opcode_t op)
@@ -887,6 +1315,7 @@ void spu_recompiler::STQX(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::host::oword_ptr(*ls, *addr), vt);
+	CheckCodeStore();
 	c->unuse(*addr);
 }
 
@@ -908,7 +1337,7 @@ void spu_recompiler::BISL(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(spu_branch_target(m_pos + 4), 0, 0, 0)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->unuse(vr);
 
 	FunctionCall();
@@ -936,7 +1365,7 @@ void spu_recompiler::GB(spu_opcode_t op)
 	c->pmovmskb(*addr, va);
 	c->pxor(va, va);
 	c->pinsrw(va, *addr, 6);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 }
 
@@ -948,7 +1377,7 @@ void spu_recompiler::GBH(spu_opcode_t op)
 	c->pmovmskb(*addr, va);
 	c->pxor(va, va);
 	c->pinsrw(va, *addr, 6);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 }
 
@@ -959,54 +1388,50 @@ void spu_recompiler::GBB(spu_opcode_t op)
 	c->pmovmskb(*addr, va);
 	c->pxor(va, va);
 	c->pinsrw(va, *addr, 6);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 }
 
 void spu_recompiler::FSM(spu_opcode_t op)
 {
-	const XmmLink& vr = XmmAlloc();
-	c->mov(*qw0, asmjit::imm_ptr((void*)g_spu_imm.fsm));
-	c->mov(*addr, SPU_OFF_32(gpr[op.ra]._u32[3]));
-	c->and_(*addr, 0xf);
-	c->shl(*addr, 4);
-	c->movdqa(vr, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
-	c->unuse(*addr);
-	c->unuse(*qw0);
+	// broadcast preferred slot and test one bit per element (no table lookup)
+	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
+	const XmmLink& vm = XmmAlloc();
+	c->pshufd(va, va, 0xff);
+	c->movdqa(vm, XmmConst(_mm_set_epi32(8, 4, 2, 1)));
+	c->pand(va, vm);
+	c->pcmpeqd(va, vm);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FSMH(spu_opcode_t op)
 {
-	const XmmLink& vr = XmmAlloc();
-	c->mov(*qw0, asmjit::imm_ptr((void*)g_spu_imm.fsmh));
-	c->mov(*addr, SPU_OFF_32(gpr[op.ra]._u32[3]));
-	c->and_(*addr, 0xff);
-	c->shl(*addr, 4);
-	c->movdqa(vr, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
-	c->unuse(*addr);
-	c->unuse(*qw0);
+	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
+	const XmmLink& vm = XmmAlloc();
+	c->pshufb(va, XmmConst(_mm_set1_epi8(12)));
+	c->movdqa(vm, XmmConst(_mm_set_epi16(128, 64, 32, 16, 8, 4, 2, 1)));
+	c->pand(va, vm);
+	c->pcmpeqw(va, vm);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FSMB(spu_opcode_t op)
 {
-	const XmmLink& vr = XmmAlloc();
-	c->mov(*qw0, asmjit::imm_ptr((void*)g_spu_imm.fsmb));
-	c->mov(*addr, SPU_OFF_32(gpr[op.ra]._u32[3]));
-	c->and_(*addr, 0xffff);
-	c->shl(*addr, 4);
-	c->movdqa(vr, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
-	c->unuse(*addr);
-	c->unuse(*qw0);
+	// spread two low bytes of preferred slot (8 bytes each) and test one bit per byte
+	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
+	const XmmLink& vm = XmmAlloc();
+	c->pshufb(va, XmmConst(_mm_set_epi8(13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12, 12, 12, 12, 12, 12)));
+	c->movdqa(vm, XmmConst(_mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1)));
+	c->pand(va, vm);
+	c->pcmpeqb(va, vm);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FREST(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
 	c->rcpps(va, va);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FRSQEST(spu_opcode_t op)
@@ -1014,7 +1439,7 @@ void spu_recompiler::FRSQEST(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
 	c->andps(va, XmmConst(_mm_set1_epi32(0x7fffffff))); // abs
 	c->rsqrtps(va, va);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::LQX(spu_opcode_t op)
@@ -1026,21 +1451,24 @@ void spu_recompiler::LQX(spu_opcode_t op)
 	const XmmLink& vt = XmmAlloc();
 	c->movdqa(vt, asmjit::host::oword_ptr(*ls, *addr));
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 	c->unuse(*addr);
 }
 
 void spu_recompiler::ROTQBYBI(spu_opcode_t op)
 {
+	// build the shuffle mask from the broadcast count byte (bits 3..6), no table and no scalar read of op.rb
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->mov(*qw0, asmjit::imm_ptr((void*)g_spu_imm.rldq_pshufb));
-	c->mov(*addr, SPU_OFF_32(gpr[op.rb]._u32[3]));
-	c->and_(*addr, 0xf << 3);
-	c->shl(*addr, 1);
-	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
-	c->unuse(*addr);
-	c->unuse(*qw0);
+	const XmmLink& vn = XmmAlloc();
+	const XmmLink& vm = XmmAlloc();
+	c->movdqa(vn, XmmRead(op.rb));
+	c->pshufb(vn, XmmConst(_mm_set1_epi8(12)));
+	c->psrlw(vn, 3); // bits shifted in from the neighbouring byte are removed by the final mask
+	c->movdqa(vm, XmmConst(_mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)));
+	c->psubb(vm, vn);
+	c->pand(vm, XmmConst(_mm_set1_epi8(0xf)));
+	c->pshufb(va, vm);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTQMBYBI(spu_opcode_t op)
@@ -1053,7 +1481,7 @@ void spu_recompiler::ROTQMBYBI(spu_opcode_t op)
 	c->and_(*addr, 0x1f);
 	c->shl(*addr, 4);
 	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 	c->unuse(*qw0);
 }
@@ -1066,7 +1494,7 @@ void spu_recompiler::SHLQBYBI(spu_opcode_t op)
 	c->and_(*addr, 0x1f << 3);
 	c->shl(*addr, 1);
 	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 	c->unuse(*qw0);
 }
@@ -1080,7 +1508,7 @@ void spu_recompiler::CBX(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::byte_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x03);
 	c->unuse(*addr);
 }
@@ -1094,7 +1522,7 @@ void spu_recompiler::CHX(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::word_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x0203);
 	c->unuse(*addr);
 }
@@ -1108,7 +1536,7 @@ void spu_recompiler::CWX(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::dword_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x00010203);
 	c->unuse(*addr);
 }
@@ -1122,7 +1550,7 @@ void spu_recompiler::CDX(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(*qw0, asmjit::imm_u(0x0001020304050607));
 	c->mov(asmjit::host::qword_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), *qw0);
 	c->unuse(*addr);
@@ -1179,15 +1607,17 @@ void spu_recompiler::SHLQBI(spu_opcode_t op)
 
 void spu_recompiler::ROTQBY(spu_opcode_t op)
 {
+	// mask byte i = (i - count) & 0xf, computed in xmm registers (op.rb stays cached)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->mov(*qw0, asmjit::imm_ptr((void*)g_spu_imm.rldq_pshufb));
-	c->mov(*addr, SPU_OFF_32(gpr[op.rb]._u32[3]));
-	c->and_(*addr, 0xf);
-	c->shl(*addr, 4);
-	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
-	c->unuse(*addr);
-	c->unuse(*qw0);
+	const XmmLink& vn = XmmAlloc();
+	const XmmLink& vm = XmmAlloc();
+	c->movdqa(vn, XmmRead(op.rb));
+	c->pshufb(vn, XmmConst(_mm_set1_epi8(12)));
+	c->movdqa(vm, XmmConst(_mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)));
+	c->psubb(vm, vn);
+	c->pand(vm, XmmConst(_mm_set1_epi8(0xf)));
+	c->pshufb(va, vm);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTQMBY(spu_opcode_t op)
@@ -1199,7 +1629,7 @@ void spu_recompiler::ROTQMBY(spu_opcode_t op)
 	c->and_(*addr, 0x1f);
 	c->shl(*addr, 4);
 	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 	c->unuse(*qw0);
 }
@@ -1212,7 +1642,7 @@ void spu_recompiler::SHLQBY(spu_opcode_t op)
 	c->and_(*addr, 0x1f);
 	c->shl(*addr, 4);
 	c->pshufb(va, asmjit::host::oword_ptr(*qw0, *addr));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 	c->unuse(*addr);
 	c->unuse(*qw0);
 }
@@ -1240,7 +1670,7 @@ void spu_recompiler::CBD(spu_opcode_t op)
 	//	v128 value = v128::fromV(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f));
 	//	value.u8r[op.i7 & 0xf] = 0x03;
 	//	c->movdqa(vr, XmmConst(value));
-	//	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	//	XmmSet(op.rt, vr);
 	//	return;
 	//}
 
@@ -1251,7 +1681,7 @@ void spu_recompiler::CBD(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::byte_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x03);
 	c->unuse(*addr);
 }
@@ -1265,7 +1695,7 @@ void spu_recompiler::CHD(spu_opcode_t op)
 	//	v128 value = v128::fromV(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f));
 	//	value.u16r[(op.i7 >> 1) & 0x7] = 0x0203;
 	//	c->movdqa(vr, XmmConst(value));
-	//	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	//	XmmSet(op.rt, vr);
 	//	return;
 	//}
 
@@ -1276,7 +1706,7 @@ void spu_recompiler::CHD(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::word_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x0203);
 	c->unuse(*addr);
 }
@@ -1290,7 +1720,7 @@ void spu_recompiler::CWD(spu_opcode_t op)
 	//	v128 value = v128::fromV(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f));
 	//	value.u32r[(op.i7 >> 2) & 0x3] = 0x00010203;
 	//	c->movdqa(vr, XmmConst(value));
-	//	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	//	XmmSet(op.rt, vr);
 	//	return;
 	//}
 
@@ -1301,7 +1731,7 @@ void spu_recompiler::CWD(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(asmjit::host::dword_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), 0x00010203);
 	c->unuse(*addr);
 }
@@ -1315,7 +1745,7 @@ void spu_recompiler::CDD(spu_opcode_t op)
 	//	v128 value = v128::fromV(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f));
 	//	value.u64r[(op.i7 >> 3) & 0x1] = 0x0001020304050607ull;
 	//	c->movdqa(vr, XmmConst(value));
-	//	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	//	XmmSet(op.rt, vr);
 	//	return;
 	//}
 
@@ -1326,7 +1756,7 @@ void spu_recompiler::CDD(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(0x10111213, 0x14151617, 0x18191a1b, 0x1c1d1e1f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->mov(*qw0, asmjit::imm_u(0x0001020304050607));
 	c->mov(asmjit::host::qword_ptr(*cpu, *addr, 0, OFFSET_32(SPUThread, gpr[op.rt])), *qw0);
 	c->unuse(*addr);
@@ -1376,7 +1806,7 @@ void spu_recompiler::ROTQBYI(spu_opcode_t op)
 	const int s = op.i7 & 0xf;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->palignr(va, va, 16 - s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ROTQMBYI(spu_opcode_t op)
@@ -1384,7 +1814,7 @@ void spu_recompiler::ROTQMBYI(spu_opcode_t op)
 	const int s = 0-op.i7 & 0x1f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psrldq(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SHLQBYI(spu_opcode_t op)
@@ -1392,7 +1822,7 @@ void spu_recompiler::SHLQBYI(spu_opcode_t op)
 	const int s = op.i7 & 0x1f;
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pslldq(va, s);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::NOP(spu_opcode_t op)
@@ -1402,38 +1832,38 @@ void spu_recompiler::NOP(spu_opcode_t op)
 void spu_recompiler::CGT(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpgtd(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpgtd(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::XOR(spu_opcode_t op)
 {
 	// xor
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pxor(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pxor(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CGTH(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpgtw(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpgtw(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::EQV(spu_opcode_t op)
 {
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
 	c->pxor(vb, XmmConst(_mm_set1_epi32(0xffffffff)));
-	c->pxor(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->pxor(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::CGTB(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpgtb(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpgtb(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SUMB(spu_opcode_t op)
@@ -1446,7 +1876,7 @@ void spu_recompiler::SUMB(spu_opcode_t op)
 	c->pmaddubsw(vb, vi);
 	c->phaddw(va, vb);
 	c->pshufb(va, XmmConst(_mm_set_epi8(15, 14, 7, 6, 13, 12, 5, 4, 11, 10, 3, 2, 9, 8, 1, 0)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 //HGT uses signed values.  HLGT uses unsigned values
@@ -1501,7 +1931,7 @@ void spu_recompiler::XSHW(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pslld(va, 16);
 	c->psrad(va, 16);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CNTB(spu_opcode_t op)
@@ -1519,7 +1949,7 @@ void spu_recompiler::CNTB(spu_opcode_t op)
 	c->movdqa(va, XmmConst(_mm_set_epi8(4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0)));
 	c->pshufb(va, v1);
 	c->paddb(va, vm);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::XSBH(spu_opcode_t op)
@@ -1527,7 +1957,7 @@ void spu_recompiler::XSBH(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psllw(va, 8);
 	c->psraw(va, 8);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CLGT(spu_opcode_t op)
@@ -1537,25 +1967,25 @@ void spu_recompiler::CLGT(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movdqa(vi, XmmConst(_mm_set1_epi32(0x80000000)));
 	c->pxor(va, vi);
-	c->pxor(vi, SPU_OFF_128(gpr[op.rb]));
+	c->pxor(vi, XmmRead(op.rb));
 	c->pcmpgtd(va, vi);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ANDC(spu_opcode_t op)
 {
 	// and not
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
-	c->pandn(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->pandn(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::FCGT(spu_opcode_t op)
 {
 	// reverted less-than
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Float);
-	c->cmpps(vb, SPU_OFF_128(gpr[op.ra]), 1);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), vb);
+	c->cmpps(vb, XmmRead(op.ra), 1);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::DFCGT(spu_opcode_t op)
@@ -1566,22 +1996,22 @@ void spu_recompiler::DFCGT(spu_opcode_t op)
 void spu_recompiler::FA(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
-	c->addps(va, SPU_OFF_128(gpr[op.rb]));
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	c->addps(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FS(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
-	c->subps(va, SPU_OFF_128(gpr[op.rb]));
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	c->subps(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FM(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
-	c->mulps(va, SPU_OFF_128(gpr[op.rb]));
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	c->mulps(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CLGTH(spu_opcode_t op)
@@ -1591,17 +2021,17 @@ void spu_recompiler::CLGTH(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movdqa(vi, XmmConst(_mm_set1_epi16(INT16_MIN)));
 	c->pxor(va, vi);
-	c->pxor(vi, SPU_OFF_128(gpr[op.rb]));
+	c->pxor(vi, XmmRead(op.rb));
 	c->pcmpgtw(va, vi);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ORC(spu_opcode_t op)
 {
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
 	c->pxor(vb, XmmConst(_mm_set1_epi32(0xffffffff)));
-	c->por(vb, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	c->por(vb, XmmRead(op.ra));
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::FCMGT(spu_opcode_t op)
@@ -1611,9 +2041,9 @@ void spu_recompiler::FCMGT(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movaps(vi, XmmConst(_mm_set1_epi32(0x7fffffff)));
 	c->andps(vb, vi); // abs
-	c->andps(vi, SPU_OFF_128(gpr[op.ra]));
+	c->andps(vi, XmmRead(op.ra));
 	c->cmpps(vb, vi, 1);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), vb);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::DFCMGT(spu_opcode_t op)
@@ -1624,22 +2054,22 @@ void spu_recompiler::DFCMGT(spu_opcode_t op)
 void spu_recompiler::DFA(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
-	c->addpd(va, SPU_OFF_128(gpr[op.rb]));
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	c->addpd(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::DFS(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
-	c->subpd(va, SPU_OFF_128(gpr[op.rb]));
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	c->subpd(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::DFM(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
-	c->mulpd(va, SPU_OFF_128(gpr[op.rb]));
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	c->mulpd(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CLGTB(spu_opcode_t op)
@@ -1649,9 +2079,9 @@ void spu_recompiler::CLGTB(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movdqa(vi, XmmConst(_mm_set1_epi8(INT8_MIN)));
 	c->pxor(va, vi);
-	c->pxor(vi, SPU_OFF_128(gpr[op.rb]));
+	c->pxor(vi, XmmRead(op.rb));
 	c->pcmpgtb(va, vi);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::HLGT(spu_opcode_t op)
@@ -1668,45 +2098,45 @@ void spu_recompiler::DFMA(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmGet(op.rt, XmmType::Double);
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
-	c->mulpd(va, SPU_OFF_128(gpr[op.rb]));
+	c->mulpd(va, XmmRead(op.rb));
 	c->addpd(vr, va);
-	c->movapd(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::DFMS(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Double);
-	c->mulpd(va, SPU_OFF_128(gpr[op.rb]));
+	c->mulpd(va, XmmRead(op.rb));
 	c->subpd(va, vt);
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::DFNMS(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmGet(op.rt, XmmType::Double);
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
-	c->mulpd(va, SPU_OFF_128(gpr[op.rb]));
+	c->mulpd(va, XmmRead(op.rb));
 	c->subpd(vr, va);
-	c->movapd(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::DFNMA(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Double);
-	c->mulpd(va, SPU_OFF_128(gpr[op.rb]));
+	c->mulpd(va, XmmRead(op.rb));
 	c->addpd(vt, va);
 	c->xorpd(va, va);
 	c->subpd(va, vt);
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQ(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpeqd(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpeqd(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::MPYHHU(spu_opcode_t op)
@@ -1720,16 +2150,16 @@ void spu_recompiler::MPYHHU(spu_opcode_t op)
 	c->pand(va, XmmConst(_mm_set1_epi32(0xffff0000)));
 	c->psrld(va2, 16);
 	c->por(va, va2);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ADDX(spu_opcode_t op)
 {
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pand(vt, XmmConst(_mm_set1_epi32(1)));
-	c->paddd(vt, SPU_OFF_128(gpr[op.ra]));
-	c->paddd(vt, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	c->paddd(vt, XmmRead(op.ra));
+	c->paddd(vt, XmmRead(op.rb));
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::SFX(spu_opcode_t op)
@@ -1737,9 +2167,9 @@ void spu_recompiler::SFX(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
 	c->pandn(vt, XmmConst(_mm_set1_epi32(1)));
-	c->psubd(vb, SPU_OFF_128(gpr[op.ra]));
+	c->psubd(vb, XmmRead(op.ra));
 	c->psubd(vb, vt);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vb);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::CGX(spu_opcode_t op) //nf
@@ -1790,7 +2220,7 @@ void spu_recompiler::MPYHHA(spu_opcode_t op)
 	c->psrld(vb, 16);
 	c->pmaddwd(va, vb);
 	c->paddd(vt, va);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::MPYHHAU(spu_opcode_t op)
@@ -1806,7 +2236,7 @@ void spu_recompiler::MPYHHAU(spu_opcode_t op)
 	c->psrld(va2, 16);
 	c->paddd(vt, va);
 	c->paddd(vt, va2);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::FSCRRD(spu_opcode_t op)
@@ -1814,7 +2244,7 @@ void spu_recompiler::FSCRRD(spu_opcode_t op)
 	// zero (hack)
 	const XmmLink& v0 = XmmAlloc();
 	c->pxor(v0, v0);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), v0);
+	XmmSet(op.rt, v0);
 }
 
 void spu_recompiler::FESD(spu_opcode_t op)
@@ -1822,7 +2252,7 @@ void spu_recompiler::FESD(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
 	c->shufps(va, va, 0x8d); // _f[0] = _f[1]; _f[1] = _f[3];
 	c->cvtps2pd(va, va);
-	c->movapd(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FRDS(spu_opcode_t op)
@@ -1830,7 +2260,7 @@ void spu_recompiler::FRDS(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Double);
 	c->cvtpd2ps(va, va);
 	c->shufps(va, va, 0x72); // _f[1] = _f[0]; _f[3] = _f[1]; _f[0] = _f[2] = 0;
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FSCRWR(spu_opcode_t op)
@@ -1847,8 +2277,8 @@ void spu_recompiler::FCEQ(spu_opcode_t op)
 {
 	// compare equal
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Float);
-	c->cmpps(vb, SPU_OFF_128(gpr[op.ra]), 0);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), vb);
+	c->cmpps(vb, XmmRead(op.ra), 0);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::DFCEQ(spu_opcode_t op)
@@ -1865,7 +2295,7 @@ void spu_recompiler::MPY(spu_opcode_t op)
 	c->pand(va, vi);
 	c->pand(vb, vi);
 	c->pmaddwd(va, vb);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::MPYH(spu_opcode_t op)
@@ -1875,7 +2305,7 @@ void spu_recompiler::MPYH(spu_opcode_t op)
 	c->psrld(va, 16);
 	c->pmullw(va, vb);
 	c->pslld(va, 16);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::MPYHH(spu_opcode_t op)
@@ -1885,7 +2315,7 @@ void spu_recompiler::MPYHH(spu_opcode_t op)
 	c->psrld(va, 16);
 	c->psrld(vb, 16);
 	c->pmaddwd(va, vb);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::MPYS(spu_opcode_t op)
@@ -1895,14 +2325,14 @@ void spu_recompiler::MPYS(spu_opcode_t op)
 	c->pmulhw(va, vb);
 	c->pslld(va, 16);
 	c->psrad(va, 16);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQH(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpeqw(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpeqw(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FCMEQ(spu_opcode_t op)
@@ -1911,9 +2341,9 @@ void spu_recompiler::FCMEQ(spu_opcode_t op)
 	const XmmLink& vi = XmmAlloc();
 	c->movaps(vi, XmmConst(_mm_set1_epi32(0x7fffffff)));
 	c->andps(vb, vi); // abs
-	c->andps(vi, SPU_OFF_128(gpr[op.ra]));
+	c->andps(vi, XmmRead(op.ra));
 	c->cmpps(vb, vi, 0); // ==
-	c->movaps(SPU_OFF_128(gpr[op.rt]), vb);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::DFCMEQ(spu_opcode_t op)
@@ -1932,21 +2362,21 @@ void spu_recompiler::MPYU(spu_opcode_t op)
 	c->pslld(va, 16);
 	c->pand(va2, XmmConst(_mm_set1_epi32(0xffff)));
 	c->por(va, va2);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQB(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
-	c->pcmpeqb(va, SPU_OFF_128(gpr[op.rb]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	c->pcmpeqb(va, XmmRead(op.rb));
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::FI(spu_opcode_t op)
 {
 	// Floating Interpolate
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Float);
-	c->movaps(SPU_OFF_128(gpr[op.rt]), vb);
+	XmmSet(op.rt, vb);
 }
 
 void spu_recompiler::HEQ(spu_opcode_t op)
@@ -1968,7 +2398,7 @@ void spu_recompiler::CFLTS(spu_opcode_t op)
 	c->cmpps(vi, va, 2);
 	c->cvttps2dq(va, va); // convert to ints with truncation
 	c->pxor(va, vi); // fix result saturation (0x80000000 -> 0x7fffffff)
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CFLTU(spu_opcode_t op)
@@ -1990,7 +2420,7 @@ void spu_recompiler::CFLTU(spu_opcode_t op)
 	c->cvttps2dq(vs2, vs2);
 	c->por(va, vs);
 	c->por(va, vs2);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CSFLT(spu_opcode_t op)
@@ -1998,7 +2428,7 @@ void spu_recompiler::CSFLT(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->cvtdq2ps(va, va); // convert to floats
 	if (op.i8 != 155) c->mulps(va, XmmConst(_mm_set1_ps(exp2f(static_cast<s16>(op.i8 - 155))))); // scale
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CUFLT(spu_opcode_t op)
@@ -2012,7 +2442,7 @@ void spu_recompiler::CUFLT(spu_opcode_t op)
 	c->andps(v1, XmmConst(_mm_set1_ps(exp2f(31)))); // generate correction component
 	c->addps(va, v1); // add correction component
 	if (op.i8 != 155) c->mulps(va, XmmConst(_mm_set1_ps(exp2f(static_cast<s16>(op.i8 - 155))))); // scale
-	c->movaps(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::BRZ(spu_opcode_t op)
@@ -2045,6 +2475,7 @@ void spu_recompiler::STQA(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::host::oword_ptr(*ls, spu_ls_target(0, op.i16)), vt);
+	CheckCodeStore(spu_ls_target(0, op.i16));
 }
 
 void spu_recompiler::BRNZ(spu_opcode_t op)
@@ -2127,6 +2558,7 @@ void spu_recompiler::STQR(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::host::oword_ptr(*ls, spu_ls_target(m_pos, op.i16)), vt);
+	CheckCodeStore(spu_ls_target(m_pos, op.i16));
 }
 
 void spu_recompiler::BRA(spu_opcode_t op)
@@ -2157,7 +2589,7 @@ void spu_recompiler::LQA(spu_opcode_t op)
 	const XmmLink& vt = XmmAlloc();
 	c->movdqa(vt, asmjit::host::oword_ptr(*ls, spu_ls_target(0, op.i16)));
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::BRASL(spu_opcode_t op)
@@ -2168,7 +2600,7 @@ void spu_recompiler::BRASL(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(spu_branch_target(m_pos + 4), 0, 0, 0)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->unuse(vr);
 
 	c->mov(SPU_OFF_32(pc), target);
@@ -2210,9 +2642,16 @@ void spu_recompiler::BR(spu_opcode_t op)
 
 void spu_recompiler::FSMBI(spu_opcode_t op)
 {
+	v128 mask;
+
+	for (u32 j = 0; j < 16; j++)
+	{
+		mask._u8[j] = (op.i16 & (1 << j)) ? 0xff : 0;
+	}
+
 	const XmmLink& vr = XmmAlloc();
-	c->movdqa(vr, XmmConst(g_spu_imm.fsmb[op.i16]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	c->movdqa(vr, XmmConst(mask));
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::BRSL(spu_opcode_t op)
@@ -2223,7 +2662,7 @@ void spu_recompiler::BRSL(spu_opcode_t op)
 
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set_epi32(spu_branch_target(m_pos + 4), 0, 0, 0)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 	c->unuse(vr);
 
 	if (target == spu_branch_target(m_pos + 4))
@@ -2242,93 +2681,93 @@ void spu_recompiler::LQR(spu_opcode_t op)
 	const XmmLink& vt = XmmAlloc();
 	c->movdqa(vt, asmjit::host::oword_ptr(*ls, spu_ls_target(m_pos, op.i16)));
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::IL(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi32(op.si16)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::ILHU(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi32(op.i16 << 16)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::ILH(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi16(op.i16)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::IOHL(spu_opcode_t op)
 {
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->por(vt, XmmConst(_mm_set1_epi32(op.i16)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 }
 
 void spu_recompiler::ORI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	if (op.si10) c->por(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ORHI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->por(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ORBI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->por(va, XmmConst(_mm_set1_epi8(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::SFI(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi32(op.si10)));
-	c->psubd(vr, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	c->psubd(vr, XmmRead(op.ra));
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::SFHI(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi16(op.si10)));
-	c->psubw(vr, SPU_OFF_128(gpr[op.ra]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	c->psubw(vr, XmmRead(op.ra));
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::ANDI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pand(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ANDHI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pand(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::ANDBI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pand(va, XmmConst(_mm_set1_epi8(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::AI(spu_opcode_t op)
@@ -2336,7 +2775,7 @@ void spu_recompiler::AI(spu_opcode_t op)
 	// add
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->paddd(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::AHI(spu_opcode_t op)
@@ -2344,7 +2783,7 @@ void spu_recompiler::AHI(spu_opcode_t op)
 	// add
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->paddw(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::STQD(spu_opcode_t op)
@@ -2356,6 +2795,7 @@ void spu_recompiler::STQD(spu_opcode_t op)
 	const XmmLink& vt = XmmGet(op.rt, XmmType::Int);
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
 	c->movdqa(asmjit::host::oword_ptr(*ls, *addr), vt);
+	CheckCodeStore();
 	c->unuse(*addr);
 }
 
@@ -2368,7 +2808,7 @@ void spu_recompiler::LQD(spu_opcode_t op)
 	const XmmLink& vt = XmmAlloc();
 	c->movdqa(vt, asmjit::host::oword_ptr(*ls, *addr));
 	c->pshufb(vt, XmmConst(_mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vt);
+	XmmSet(op.rt, vt);
 	c->unuse(*addr);
 }
 
@@ -2376,42 +2816,42 @@ void spu_recompiler::XORI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pxor(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::XORHI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pxor(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::XORBI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pxor(va, XmmConst(_mm_set1_epi8(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CGTI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpgtd(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CGTHI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpgtw(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CGTBI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpgtb(va, XmmConst(_mm_set1_epi8(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::HGTI(spu_opcode_t op)
@@ -2429,7 +2869,7 @@ void spu_recompiler::CLGTI(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pxor(va, XmmConst(_mm_set1_epi32(0x80000000)));
 	c->pcmpgtd(va, XmmConst(_mm_set1_epi32(op.si10 - 0x80000000)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CLGTHI(spu_opcode_t op)
@@ -2437,7 +2877,7 @@ void spu_recompiler::CLGTHI(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pxor(va, XmmConst(_mm_set1_epi16(INT16_MIN)));
 	c->pcmpgtw(va, XmmConst(_mm_set1_epi16(op.si10 - 0x8000)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CLGTBI(spu_opcode_t op)
@@ -2445,7 +2885,7 @@ void spu_recompiler::CLGTBI(spu_opcode_t op)
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->psubb(va, XmmConst(_mm_set1_epi8(INT8_MIN)));
 	c->pcmpgtb(va, XmmConst(_mm_set1_epi8(op.si10 - 0x80)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::HLGTI(spu_opcode_t op)
@@ -2462,7 +2902,7 @@ void spu_recompiler::MPYI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pmaddwd(va, XmmConst(_mm_set1_epi32(op.si10 & 0xffff)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::MPYUI(spu_opcode_t op)
@@ -2476,28 +2916,28 @@ void spu_recompiler::MPYUI(spu_opcode_t op)
 	c->pmullw(va2, vi);
 	c->pslld(va, 16);
 	c->por(va, va2);
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpeqd(va, XmmConst(_mm_set1_epi32(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQHI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpeqw(va, XmmConst(_mm_set1_epi16(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::CEQBI(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Int);
 	c->pcmpeqb(va, XmmConst(_mm_set1_epi8(op.si10)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), va);
+	XmmSet(op.rt, va);
 }
 
 void spu_recompiler::HEQI(spu_opcode_t op)
@@ -2522,7 +2962,7 @@ void spu_recompiler::ILA(spu_opcode_t op)
 {
 	const XmmLink& vr = XmmAlloc();
 	c->movdqa(vr, XmmConst(_mm_set1_epi32(op.i18)));
-	c->movdqa(SPU_OFF_128(gpr[op.rt]), vr);
+	XmmSet(op.rt, vr);
 }
 
 void spu_recompiler::SELB(spu_opcode_t op)
@@ -2530,13 +2970,38 @@ void spu_recompiler::SELB(spu_opcode_t op)
 	const XmmLink& vb = XmmGet(op.rb, XmmType::Int);
 	const XmmLink& vc = XmmGet(op.rc, XmmType::Int);
 	c->pand(vb, vc);
-	c->pandn(vc, SPU_OFF_128(gpr[op.ra]));
+	c->pandn(vc, XmmRead(op.ra));
 	c->por(vb, vc);
-	c->movdqa(SPU_OFF_128(gpr[op.rt4]), vb);
+	XmmSet(op.rt4, vb);
 }
 
 void spu_recompiler::SHUFB(spu_opcode_t op)
 {
+	if (m_avx)
+	{
+		// non-destructive VEX forms read cached registers directly; vpblendvb selects special values by mask & 10000000
+		const XmmLink& v1 = XmmAlloc();
+		const XmmLink& v2 = XmmAlloc();
+		const XmmLink& v3 = XmmAlloc();
+		const XmmLink& vr = XmmAlloc();
+		c->vpand(v1, XmmRead(op.rc), XmmConst(_mm_set1_epi8(-0x20))); // v1 = mask & 11100000
+		c->vpcmpeqb(v2, v1, XmmConst(_mm_set1_epi8(-0x20))); //        v2 = (mask & 11100000 == 11100000) ? 0xff : 0
+		c->vpcmpeqb(v1, v1, XmmConst(_mm_set1_epi8(-0x40))); //        v1 = (mask & 11100000 == 11000000) ? 0xff : 0
+		c->vpand(v2, v2, XmmConst(_mm_set1_epi8(-0x80))); //           v2 = (mask & 11100000 == 11100000) ? 0x80 : 0
+		c->vpor(v1, v1, v2); //                                        v1 = special value
+		c->vpand(v2, XmmRead(op.rc), XmmConst(_mm_set1_epi8(0x1f))); // v2 = mask & 00011111
+		c->vpxor(v2, v2, XmmConst(_mm_set1_epi8(0x10))); //            v2 = (mask & 00011111) ^ 00010000
+		c->vmovdqa(v3, XmmConst(_mm_set1_epi8(0x0f)));
+		c->vpsubb(v2, v3, v2); //                                      v2 = 00001111 - ((mask & 00011111) ^ 00010000)
+		c->vpxor(v3, v2, XmmConst(_mm_set1_epi8(-0x10))); //           v3 = v2 ^ 11110000
+		c->vpshufb(vr, XmmRead(op.rb), v2); //                         vr = select(op.rb, v2)
+		c->vpshufb(v3, XmmRead(op.ra), v3); //                         v3 = select(op.ra, v3)
+		c->vpor(vr, vr, v3);
+		c->vpblendvb(vr, vr, v1, XmmRead(op.rc)); //                   vr = (mask & 10000000) ? v1 : vr
+		XmmSet(op.rt4, vr);
+		return;
+	}
+
 	const XmmLink& v0 = XmmGet(op.rc, XmmType::Int); // v0 = mask
 	const XmmLink& v1 = XmmAlloc();
 	const XmmLink& v2 = XmmAlloc();
@@ -2562,16 +3027,16 @@ void spu_recompiler::SHUFB(spu_opcode_t op)
 	c->movdqa(v2, XmmConst(_mm_set1_epi8(0x0f))); //   v2 = 00001111
 	c->pxor(v1, XmmConst(_mm_set1_epi8(0x10))); //   v1 = (mask & 00011111) ^ 00010000
 	c->psubb(v2, v1); //                 v2 = 00001111 - ((mask & 00011111) ^ 00010000)
-	c->movdqa(v1, SPU_OFF_128(gpr[op.rb])); //        v1 = op.rb
+	c->movdqa(v1, XmmRead(op.rb)); //        v1 = op.rb
 	c->pshufb(v1, v2); //                v1 = select(op.rb, 00001111 - ((mask & 00011111) ^ 00010000))
 	// select bytes from [op.ra]:
 	c->pxor(v2, XmmConst(_mm_set1_epi8(-0x10))); //   v2 = (00001111 - ((mask & 00011111) ^ 00010000)) ^ 11110000
-	c->movdqa(v3, SPU_OFF_128(gpr[op.ra])); //        v3 = op.ra
+	c->movdqa(v3, XmmRead(op.ra)); //        v3 = op.ra
 	c->pshufb(v3, v2); //                v3 = select(op.ra, (00001111 - ((mask & 00011111) ^ 00010000)) ^ 11110000)
 	c->por(v1, v3); //                   v1 = select(op.rb, 00001111 - ((mask & 00011111) ^ 00010000)) | (v3)
 	c->pandn(v4, v1); // filter result   v4 = v1 & ((mask & 10000000 == 10000000) ? 0 : 0xff)
 	c->por(vFF, v4); // final merge      vFF = (mask & 10000000 == 10000000) ? ((mask & 11100000 == 11000000) ? 0xff : (mask & 11100000 == 11100000) ? 0x80 : 0) : (v1)
-	c->movdqa(SPU_OFF_128(gpr[op.rt4]), vFF);
+	XmmSet(op.rt4, vFF);
 }
 
 void spu_recompiler::MPYA(spu_opcode_t op)
@@ -2583,33 +3048,33 @@ void spu_recompiler::MPYA(spu_opcode_t op)
 	c->pand(va, vi);
 	c->pand(vb, vi);
 	c->pmaddwd(va, vb);
-	c->paddd(va, SPU_OFF_128(gpr[op.rc]));
-	c->movdqa(SPU_OFF_128(gpr[op.rt4]), va);
+	c->paddd(va, XmmRead(op.rc));
+	XmmSet(op.rt4, va);
 }
 
 void spu_recompiler::FNMS(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
 	const XmmLink& vc = XmmGet(op.rc, XmmType::Float);
-	c->mulps(va, SPU_OFF_128(gpr[op.rb]));
+	c->mulps(va, XmmRead(op.rb));
 	c->subps(vc, va);
-	c->movaps(SPU_OFF_128(gpr[op.rt4]), vc);
+	XmmSet(op.rt4, vc);
 }
 
 void spu_recompiler::FMA(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
-	c->mulps(va, SPU_OFF_128(gpr[op.rb]));
-	c->addps(va, SPU_OFF_128(gpr[op.rc]));
-	c->movaps(SPU_OFF_128(gpr[op.rt4]), va);
+	c->mulps(va, XmmRead(op.rb));
+	c->addps(va, XmmRead(op.rc));
+	XmmSet(op.rt4, va);
 }
 
 void spu_recompiler::FMS(spu_opcode_t op)
 {
 	const XmmLink& va = XmmGet(op.ra, XmmType::Float);
-	c->mulps(va, SPU_OFF_128(gpr[op.rb]));
-	c->subps(va, SPU_OFF_128(gpr[op.rc]));
-	c->movaps(SPU_OFF_128(gpr[op.rt4]), va);
+	c->mulps(va, XmmRead(op.rb));
+	c->subps(va, XmmRead(op.rc));
+	XmmSet(op.rt4, va);
 }
 
 void spu_recompiler::UNK(spu_opcode_t op)
@@ -17,6 +17,9 @@ class spu_recompiler : public SPURecompilerBase
 {
 	const std::shared_ptr<asmjit::JitRuntime> m_jit;
 
+	// host CPU features (select alternative emitters)
+	bool m_avx = false;
+
 public:
 	spu_recompiler();
 
@@ -37,6 +40,12 @@ private:
 	asmjit::X86GpVar* qw2;
 	std::array<asmjit::X86XmmVar*, 6> vec;
 
+	// register cache:
+	asmjit::X86XmmVar* m_gpr_vars; // array[128]
+	std::array<asmjit::X86XmmVar*, 128> m_gpr_cache; // SPU registers currently held in xmm vars
+	std::array<bool, 128> m_gpr_dirty; // cached SPU registers which must be written back
+	u32 m_gpr_loads, m_gpr_reads, m_gpr_stores, m_gpr_writes; // statistics (memory accesses / register accesses)
+
 	// labels:
 	asmjit::Label* labels; // array[0x10000]
 	asmjit::Label* jt; // jump table resolver (uses *addr)
@@ -70,6 +79,10 @@ private:
 
 	XmmLink XmmAlloc();
 	XmmLink XmmGet(s8 reg, XmmType type);
+	asmjit::X86XmmVar& XmmRead(s8 reg);
+	void XmmSet(s8 reg, asmjit::X86XmmVar& value);
+	void XmmFlush(u32 first = 0, u32 last = 128);
+	u32 XmmSync(u32 offset, u32 size); // used by SPU_OFF_* macros
 
 	asmjit::X86Mem XmmConst(v128 data);
 	asmjit::X86Mem XmmConst(__m128 data);
@@ -78,6 +91,10 @@ private:
 private:
 	void InterpreterCall(spu_opcode_t op);
 	void FunctionCall();
+	void CheckSchedule(); // decrement the scheduler budget at block entry (check the time slice if exhausted)
+	void SetScalar(s8 reg, asmjit::X86GpVar& value); // set u32 value in the preferred slot of the register
+	void CheckCodeStore(); // check store to *addr (set ls_code_dirty if necessary)
+	void CheckCodeStore(u32 lsa); // check store to constant address
 
 	void STOP(spu_opcode_t op);
 	void LNOP(spu_opcode_t op);
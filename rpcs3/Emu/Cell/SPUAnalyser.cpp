@@ -1,40 +1,256 @@
 #include "stdafx.h"
+#include "Emu/System.h"
 
-#include "Crypto/sha1.h"
 #include "SPURecompiler.h"
 #include "SPUAnalyser.h"
 
 const spu_opcode_table_t<spu_itype_t> g_spu_itype{ DEFINE_SPU_OPCODES(spu_itype::), spu_itype::UNK };
 
+u64 spu_function_hash_update(u64 hash, const be_t<u32>* data, u32 size)
+{
+	// FNV-1a over 32-bit words
+	for (u32 i = 0; i < size / 4; i++)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+u64 spu_function_hash(const be_t<u32>* data, u32 size)
+{
+	return spu_function_hash_update(spu_function_hash_init, data, size);
+}
+
 std::shared_ptr<spu_function_t> SPUDatabase::find(const be_t<u32>* data, u64 key, u32 max_size)
 {
-	for (auto found = m_db.find(key); found != m_db.end() && found->first == key; found++)
+	const auto found = m_db.find(key);
+
+	if (found == m_db.end())
+	{
+		return nullptr;
+	}
+
+	u64 hash = spu_function_hash_init;
+	u32 hashed = 0;
+
+	// Extend the prefix hash for each distinct function size (groups are sorted by size), so LS contents are hashed only once
+	for (auto& group : found->second)
 	{
-		if (found->second->size > max_size)
+		if (group.first > max_size)
 		{
-			continue;
+			break;
 		}
 
-		// Compare binary data explicitly (TODO: optimize)
-		if (std::equal(found->second->data.begin(), found->second->data.end(), data))
+		hash = spu_function_hash_update(hash, data + hashed / 4, group.first - hashed);
+		hashed = group.first;
+
+		const auto func = group.second.find(hash);
+
+		// Compare binary data explicitly to exclude hash collisions
+		if (func != group.second.end() && std::equal(func->second->data.begin(), func->second->data.end(), data))
 		{
-			return found->second;
+			return func->second;
 		}
 	}
 
 	return nullptr;
 }
 
+bool SPUDatabase::add(const std::shared_ptr<spu_function_t>& func)
+{
+	func->hash = spu_function_hash(func->data.data(), func->size);
+
+	if (!m_db[func->addr | u64{ func->data[0] } << 32][func->size].emplace(func->hash, func).second)
+	{
+		return false;
+	}
+
+	m_count++;
+	return true;
+}
+
+// SPU database file header
+struct spu_db_header_t
+{
+	char magic[4]; // "SPDB"
+	u32 version;
+	u32 count; // number of functions
+};
+
+const u32 g_spu_db_version = 3;
+
 SPUDatabase::SPUDatabase()
+	: m_path(Emu.GetTitleID().empty() ? std::string{} : fs::get_config_dir() + "data/" + Emu.GetTitleID() + "/spu.db")
 {
-	// TODO: load existing database associated with currently running executable
+	if (!m_path.empty())
+	{
+		load();
+	}
 
-	LOG_SUCCESS(SPU, "SPU Database initialized...");
+	LOG_SUCCESS(SPU, "SPU Database initialized (%u functions loaded)...", size32(m_loaded));
 }
 
 SPUDatabase::~SPUDatabase()
 {
-	// TODO: serialize database
+	if (!m_path.empty())
+	{
+		save();
+	}
+}
+
+void SPUDatabase::load()
+{
+	const fs::file f(m_path);
+
+	if (!f)
+	{
+		return;
+	}
+
+	const std::string buf = f.to_string();
+
+	std::size_t pos = 0;
+
+	// Read raw data (returns false on unexpected end of data)
+	const auto read = [&](void* data, std::size_t size) -> bool
+	{
+		if (buf.size() - pos < size)
+		{
+			return false;
+		}
+
+		std::memcpy(data, buf.data() + pos, size);
+		pos += size;
+		return true;
+	};
+
+	const auto read_set = [&](std::set<u32>& set, u32 count) -> bool
+	{
+		// check the size before allocating (count comes from the file)
+		if (count > (buf.size() - pos) / sizeof(u32))
+		{
+			return false;
+		}
+
+		std::vector<u32> values(count);
+
+		if (!read(values.data(), count * sizeof(u32)))
+		{
+			return false;
+		}
+
+		set.insert(values.begin(), values.end());
+		return true;
+	};
+
+	spu_db_header_t header;
+
+	if (!read(&header, sizeof(header)) || std::memcmp(header.magic, "SPDB", 4) || header.version != g_spu_db_version)
+	{
+		LOG_ERROR(SPU, "SPU Database: invalid file '%s' (ignored)", m_path);
+		return;
+	}
+
+	for (u32 i = 0; i < header.count; i++)
+	{
+		// addr, size, does_reset_stack, blocks count, adjacent count, jtable count
+		u32 info[6];
+
+		if (!read(info, sizeof(info)) || info[0] >= 0x40000 || info[0] % 4 || !info[1] || info[1] > 0x40000 - info[0] || info[1] % 4)
+		{
+			LOG_ERROR(SPU, "SPU Database: corrupted file '%s' (function %u)", m_path, i);
+			break;
+		}
+
+		auto func = std::make_shared<spu_function_t>(info[0], info[1]);
+
+		func->does_reset_stack = info[2] != 0;
+		func->data.resize(info[1] / 4);
+
+		u64 hash;
+
+		if (!read_set(func->blocks, info[3]) || !read_set(func->adjacent, info[4]) || !read_set(func->jtable, info[5]) ||
+			!read(func->data.data(), info[1]) || !read(&hash, sizeof(hash)))
+		{
+			LOG_ERROR(SPU, "SPU Database: corrupted file '%s' (function %u)", m_path, i);
+			break;
+		}
+
+		if (spu_function_hash(func->data.data(), func->size) != hash)
+		{
+			LOG_ERROR(SPU, "SPU Database: hash mismatch (function 0x%05x)", func->addr);
+			continue;
+		}
+
+		if (add(func))
+		{
+			m_loaded.emplace_back(func);
+		}
+	}
+}
+
+void SPUDatabase::save()
+{
+	reader_lock lock(m_mutex);
+
+	if (!m_count)
+	{
+		return;
+	}
+
+	std::string buf;
+
+	const auto write = [&](const void* data, std::size_t size)
+	{
+		buf.append(static_cast<const char*>(data), size);
+	};
+
+	const auto write_set = [&](const std::set<u32>& set)
+	{
+		for (const u32 value : set)
+		{
+			write(&value, sizeof(u32));
+		}
+	};
+
+	const spu_db_header_t header{ { 'S', 'P', 'D', 'B' }, g_spu_db_version, m_count };
+
+	write(&header, sizeof(header));
+
+	for (auto& key : m_db) for (auto& group : key.second) for (auto& pair : group.second)
+	{
+		const auto& func = *pair.second;
+
+		const u32 info[6] = { func.addr, func.size, func.does_reset_stack, size32(func.blocks), size32(func.adjacent), size32(func.jtable) };
+
+		write(info, sizeof(info));
+		write_set(func.blocks);
+		write_set(func.adjacent);
+		write_set(func.jtable);
+		write(func.data.data(), func.size);
+		write(&func.hash, sizeof(func.hash));
+	}
+
+	fs::create_path(m_path.substr(0, m_path.find_last_of('/')));
+
+	const fs::file f(m_path, fom::rewrite);
+
+	if (!f)
+	{
+		LOG_ERROR(SPU, "SPU Database: failed to open '%s'", m_path);
+		return;
+	}
+
+	f.write(buf);
+
+	LOG_NOTICE(SPU, "SPU Database: %u functions saved", m_count);
+}
+
+std::vector<std::shared_ptr<spu_function_t>> SPUDatabase::get_loaded() const
+{
+	return m_loaded;
 }
 
 std::shared_ptr<spu_function_t> SPUDatabase::analyse(const be_t<u32>* ls, u32 entry, u32 max_limit)
@@ -335,9 +551,24 @@ std::shared_ptr<spu_function_t> SPUDatabase::analyse(const be_t<u32>* ls, u32 en
 	func->does_reset_stack = ila_sp_pos < limit;
 
 	// Add function to the database
-	m_db.emplace(key, func);
+	add(func);
 
 	LOG_SUCCESS(SPU, "Function detected [0x%05x-0x%05x] (size=0x%x)", func->addr, func->addr + func->size, func->size);
 
 	return func;
 }
+
+std::shared_ptr<spu_function_t> SPUDatabase::find_function(u32 addr)
+{
+	reader_lock lock(m_mutex);
+
+	for (auto& key : m_db) for (auto& group : key.second) for (auto& func : group.second)
+	{
+		if (addr >= func.second->addr && addr < func.second->addr + func.second->size)
+		{
+			return func.second;
+		}
+	}
+
+	return nullptr;
+}
@@ -246,8 +246,14 @@ struct spu_function_t
 	// whether ila $SP,* instruction found
 	bool does_reset_stack;
 
-	// pointer to the compiled function
-	spu_jit_func_t compiled = nullptr;
+	// content hash (see spu_function_hash)
+	u64 hash = 0;
+
+	// pointer to the compiled function (published by the compiler thread with release semantics)
+	atomic_t<spu_jit_func_t> compiled{ nullptr };
+
+	// whether the function was added to the compile queue
+	atomic_t<bool> queued{ false };
 
 	spu_function_t(u32 addr, u32 size)
 		: addr(addr)
@@ -256,21 +262,57 @@ struct spu_function_t
 	}
 };
 
+// Initial value of SPU function content hash
+const u64 spu_function_hash_init = 0xcbf29ce484222325ull;
+
+// Continue content hash with the next part of SPU function binary (size in bytes)
+u64 spu_function_hash_update(u64 hash, const be_t<u32>* data, u32 size);
+
+// Get content hash of SPU function binary (not cryptographic, collisions are checked by comparing the data)
+u64 spu_function_hash(const be_t<u32>* data, u32 size);
+
 // SPU Function Database (must be global or PS3 process-local)
 class SPUDatabase final
 {
 	shared_mutex m_mutex;
 
-	// All registered functions (uses addr and first instruction as a key)
-	std::unordered_multimap<u64, std::shared_ptr<spu_function_t>> m_db;
+	// Functions with the same entry point, first instruction and size (content hash -> function)
+	using size_group_t = std::unordered_map<u64, std::shared_ptr<spu_function_t>>;
+
+	// All registered functions (uses addr and first instruction as a key, then size and content hash)
+	std::unordered_map<u64, std::map<u32, size_group_t>> m_db;
+
+	// Number of registered functions
+	u32 m_count = 0;
+
+	// Functions loaded from the database file
+	std::vector<std::shared_ptr<spu_function_t>> m_loaded;
+
+	// Database file path (empty if not associated with the title)
+	const std::string m_path;
 
 	// For internal use
 	std::shared_ptr<spu_function_t> find(const be_t<u32>* data, u64 key, u32 max_size);
 
+	// Register new function (sets hash, returns false if the same function already exists)
+	bool add(const std::shared_ptr<spu_function_t>& func);
+
+	// Load functions from the database file
+	void load();
+
+	// Save all functions to the database file
+	void save();
+
 public:
 	SPUDatabase();
 	~SPUDatabase();
 
 	// Try to retrieve SPU function information
 	std::shared_ptr<spu_function_t> analyse(const be_t<u32>* ls, u32 entry, u32 limit = 0x40000);
+
+	// Find any registered function containing specified LS address (slow, for diagnostic purposes)
+	std::shared_ptr<spu_function_t> find_function(u32 addr);
+
+	// Get functions loaded from the database file (for precompilation)
+	std::vector<std::shared_ptr<spu_function_t>> get_loaded() const;
 };
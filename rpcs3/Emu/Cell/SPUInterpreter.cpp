@@ -335,7 +335,9 @@ void spu_interpreter::STOPD(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQX(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.ls_code_store(lsa);
 }
 
 void spu_interpreter::BI(SPUThread& spu, spu_opcode_t op)
@@ -977,6 +979,7 @@ void spu_interpreter::BRZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQA(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(0, op.i16)) = spu.gpr[op.rt];
+	spu.ls_code_store(spu_ls_target(0, op.i16));
 }
 
 void spu_interpreter::BRNZ(SPUThread& spu, spu_opcode_t op)
@@ -1006,6 +1009,7 @@ void spu_interpreter::BRHNZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQR(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(spu.pc, op.i16)) = spu.gpr[op.rt];
+	spu.ls_code_store(spu_ls_target(spu.pc, op.i16));
 }
 
 void spu_interpreter::BRA(SPUThread& spu, spu_opcode_t op)
@@ -1120,7 +1124,9 @@ void spu_interpreter::AHI(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQD(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.ls_code_store(lsa);
 }
 
 void spu_interpreter::LQD(SPUThread& spu, spu_opcode_t op)
@@ -2073,3 +2079,65 @@ void spu_interpreter::precise::FNMS(SPUThread& spu, spu_opcode_t op) { FMA(spu,
 void spu_interpreter::precise::FMA(SPUThread& spu, spu_opcode_t op) { FMA(spu, op, false, false); }
 
 void spu_interpreter::precise::FMS(SPUThread& spu, spu_opcode_t op) { FMA(spu, op, false, true); }
+
+
+spu_decoded_ls_t::spu_decoded_ls_t(const spu_opcode_table_t<spu_inter_func_t>& table)
+	: m_table(table)
+{
+}
+
+void spu_decoded_ls_t::decode(SPUThread& spu, spu_opcode_t op)
+{
+	auto& _this = *spu.ls_decoded;
+
+	// mark the line before reading the opcode again: a concurrent LS write either is seen here or sets ls_code_dirty
+	spu.ls_code_map[spu.pc / 128 / 64] |= 1ull << (spu.pc / 128 % 64);
+
+	op.opcode = *vm::ps3::_ptr<const u32>(spu.offset + spu.pc);
+
+	const auto func = _this.m_table[op.opcode];
+
+	_this.m_funcs[spu.pc / 4] = func;
+
+	func(spu, op);
+}
+
+void spu_decoded_ls_t::reset(SPUThread& spu)
+{
+	m_funcs.fill(&decode);
+
+	for (auto& bits : spu.ls_code_map)
+	{
+		bits = 0;
+	}
+
+	spu.ls_code_dirty = 0;
+
+	for (auto& bits : spu.ls_dirty_map)
+	{
+		bits = 0;
+	}
+}
+
+void spu_decoded_ls_t::update(SPUThread& spu)
+{
+	// new modifications set it again
+	spu.ls_code_dirty = 0;
+
+	for (u32 i = 0; i < spu.ls_dirty_map.size(); i++)
+	{
+		const u64 bits = spu.ls_dirty_map[i].exchange(0);
+
+		for (u32 j = 0; bits >> j; j++)
+		{
+			if (bits & (1ull << j))
+			{
+				const u32 line = i * 64 + j;
+
+				spu.ls_code_map[i] &= ~(1ull << j);
+
+				std::fill_n(m_funcs.begin() + line * 32, 32, &decode);
+			}
+		}
+	}
+}
@@ -257,3 +257,28 @@ namespace spu_interpreter
 		void FMS(SPUThread& spu, spu_opcode_t op);
 	}
 }
+
+// Pre-decoded LS (interpreter function per LS word), functions are set on first execution and reset after modification
+class spu_decoded_ls_t final
+{
+	const spu_opcode_table_t<spu_inter_func_t>& m_table;
+
+	std::array<spu_inter_func_t, 0x10000> m_funcs;
+
+	// Set the function for the current instruction and execute it
+	static void decode(SPUThread& spu, spu_opcode_t op);
+
+public:
+	spu_decoded_ls_t(const spu_opcode_table_t<spu_inter_func_t>& table);
+
+	// Reset all functions (LS could be modified externally)
+	void reset(SPUThread& spu);
+
+	// Reset functions in LS lines modified since the last update (if ls_code_dirty is set)
+	void update(SPUThread& spu);
+
+	spu_inter_func_t operator [](u32 pc) const
+	{
+		return m_funcs[pc / 4];
+	}
+};
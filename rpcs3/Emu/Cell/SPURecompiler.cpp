@@ -1,8 +1,10 @@
 #include "stdafx.h"
 #include "Emu/IdManager.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
 
 #include "SPUThread.h"
+#include "SPUInterpreter.h"
 #include "SPURecompiler.h"
 #include "SPUASMJITRecompiler.h"
 
@@ -10,9 +12,17 @@ extern u64 get_system_time();
 
 SPURecompilerDecoder::SPURecompilerDecoder(SPUThread& spu)
 	: db(fxm::get_always<SPUDatabase>())
-	, rec(fxm::get_always<spu_recompiler>())
+	, queue(fxm::get_always<spu_compile_queue_t>())
 	, spu(spu)
+	, m_entry_cache(0x10000)
+	, m_link_table(0x10000)
 {
+	for (auto& bits : spu.ls_code_map)
+	{
+		bits = 0;
+	}
+
+	spu.ls_code_dirty = 0;
 }
 
 u32 SPURecompilerDecoder::DecodeMemory(const u32 address)
@@ -25,8 +35,46 @@ u32 SPURecompilerDecoder::DecodeMemory(const u32 address)
 	// get SPU LS pointer
 	const auto _ls = vm::ps3::_ptr<u32>(spu.offset);
 
-	// always validate (TODO)
-	const auto func = db->analyse(_ls, spu.pc);
+	// flush entry cache if LS occupied by cached functions was modified
+	if (spu.ls_code_dirty)
+	{
+		std::fill(m_entry_cache.begin(), m_entry_cache.end(), nullptr);
+		std::fill(m_link_table.begin(), m_link_table.end(), nullptr);
+		for (auto& bits : spu.ls_code_map)
+		{
+			bits = 0;
+		}
+
+		spu.ls_code_dirty = 0;
+	}
+
+	auto func = m_entry_cache[spu.pc / 4].get();
+
+	if (!func)
+	{
+		// validate and cache the function (its LS lines are monitored until the next flush)
+		const auto found = db->analyse(_ls, spu.pc);
+
+		func = (m_entry_cache[spu.pc / 4] = found).get();
+
+		if (!func->compiled.load())
+		{
+			queue->push(found);
+		}
+
+		for (u32 i = func->addr / 128; i <= (func->addr + func->size - 1) / 128; i++)
+		{
+			spu.ls_code_map[i / 64] |= 1ull << (i % 64);
+		}
+
+		// LS could be modified by another thread before the lines were marked
+		if (!std::equal(func->data.begin(), func->data.end(), _ls + func->addr / 4))
+		{
+			spu.ls_code_dirty = 1;
+
+			return 0;
+		}
+	}
 
 	// reset callstack if necessary
 	if (func->does_reset_stack && spu.recursion_level)
@@ -36,45 +84,240 @@ u32 SPURecompilerDecoder::DecodeMemory(const u32 address)
 		return 0;
 	}
 
-	if (!func->compiled)
+	const auto entry = func->compiled.load();
+
+	if (!entry)
 	{
-		rec->compile(*func);
+		// use the interpreter until the function is compiled
+		interpret(*func);
 
-		if (!func->compiled) throw EXCEPTION("Compilation failed");
+		return 0;
 	}
 
-	const u32 res = func->compiled(&spu, _ls);
+	// pairs with the release fence in the compiler thread
+	std::atomic_thread_fence(std::memory_order_acquire);
 
-	if (const auto exception = spu.pending_exception)
+	if (!func->does_reset_stack)
 	{
-		spu.pending_exception = nullptr;
-		std::rethrow_exception(exception);
+		// link the function (it can be called from the loop below)
+		m_link_table[spu.pc / 4] = entry;
 	}
 
-	if (res & 0x1000000)
+	for (auto compiled = entry; compiled;)
 	{
-		spu.halt();
+		const u32 res = compiled(&spu, _ls);
+
+		if (const auto exception = spu.pending_exception)
+		{
+			spu.pending_exception = nullptr;
+			std::rethrow_exception(exception);
+		}
+
+		if (res & 0x1000000)
+		{
+			spu.halt();
+		}
+
+		if (res & 0x2000000)
+		{
+		}
+
+		if (res & 0x4000000)
+		{
+			if (res & 0x8000000)
+			{
+				throw EXCEPTION("Undefined behaviour");
+			}
+
+			spu.set_interrupt_status(true);
+		}
+		else if (res & 0x8000000)
+		{
+			spu.set_interrupt_status(false);
+		}
+
+		spu.pc = res & 0x3fffc;
+
+		// jump to the linked function directly unless something must be handled by the dispatcher
+		if (res & 0xff000000 || spu.m_state || spu.ls_code_dirty || spu.pc == m_link)
+		{
+			break;
+		}
+
+		// linked dispatches don't return to cpu_task(), time slice is checked here
+		if (spu.sched && !--spu.sched_budget)
+		{
+			spu.sched_check();
+
+			if (spu.m_state)
+			{
+				break;
+			}
+		}
+
+		compiled = m_link_table[spu.pc / 4];
 	}
 
-	if (res & 0x2000000)
+	return 0;
+}
+
+u32 SPURecompilerDecoder::call(u32 link)
+{
+	const u32 old_link = m_link;
+
+	m_link = link;
+
+	try
 	{
+		while (spu.pc != link)
+		{
+			if (spu.m_state && spu.check_status())
+			{
+				break;
+			}
+
+			DecodeMemory(spu.offset + spu.pc);
+
+			if (spu.m_state & CPU_STATE_RETURN)
+			{
+				break;
+			}
+		}
 	}
+	catch (...)
+	{
+		m_link = old_link;
+		throw;
+	}
+
+	m_link = old_link;
+
+	return spu.pc;
+}
+
+void SPURecompilerDecoder::interpret(spu_function_t& func)
+{
+	const auto& table = spu_interpreter::fast::g_spu_opcode_table;
+
+	const auto _ls = vm::ps3::_ptr<const u32>(spu.offset);
+
+	const u64 stamp = get_system_time();
 
-	if (res & 0x4000000)
+	while (!spu.m_state || !spu.check_status())
 	{
-		if (res & 0x8000000)
+		const u32 pc = spu.pc;
+
+		// leave the function, or restart it if compiled
+		if (pc < func.addr || pc >= func.addr + func.size || (pc == func.addr && func.compiled.load()))
+		{
+			break;
+		}
+
+		const u32 opcode = _ls[pc / 4];
+
+		table[opcode](spu, { opcode });
+
+		spu.pc += 4;
+
+		const spu_itype_t type = g_spu_itype[opcode];
+
+		// execute called function like spu_recompiler::FunctionCall() does
+		if ((type == spu_itype::BRSL || type == spu_itype::BRASL || type == spu_itype::BISL) && spu.pc != pc + 4)
 		{
-			throw EXCEPTION("Undefined behaviour");
+			spu.recursion_level++;
+
+			call(pc + 4);
+
+			spu.recursion_level--;
+
+			if (spu.pc != pc + 4)
+			{
+				break;
+			}
 		}
+	}
+
+	queue->interpreted_time += get_system_time() - stamp;
+}
 
-		spu.set_interrupt_status(true);
+spu_compile_queue_t::spu_compile_queue_t()
+{
+	const u32 count = std::max<u32>(1, std::min<u32>(4, std::thread::hardware_concurrency() / 4));
+
+	for (u32 i = 0; i < count; i++)
+	{
+		m_recs.emplace_back(std::make_shared<spu_recompiler>());
 	}
-	else if (res & 0x8000000)
+
+	for (u32 i = 0; i < count; i++)
 	{
-		spu.set_interrupt_status(false);
+		m_workers.emplace_back(thread_ctrl::spawn([i]() { return fmt::format("SPU Compiler Thread %u", i); }, [this, i]() { work(*m_recs[i]); }));
 	}
 
-	spu.pc = res & 0x3fffc;
+	LOG_SUCCESS(SPU, "SPU compile queue: %u worker threads", count);
+}
 
-	return 0;
+spu_compile_queue_t::~spu_compile_queue_t()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_stop = true;
+		m_cv.notify_all();
+	}
+
+	for (auto& worker : m_workers)
+	{
+		worker->join();
+	}
+
+	LOG_NOTICE(SPU, "SPU compile queue: %u functions compiled, %llu us spent in the interpreter", compiled.load(), interpreted_time.load());
+}
+
+void spu_compile_queue_t::push(const std::shared_ptr<spu_function_t>& func)
+{
+	if (func->compiled.load() || func->queued.exchange(true))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_queue.emplace_back(func);
+	depth++;
+	m_cv.notify_one();
+}
+
+void spu_compile_queue_t::work(SPURecompilerBase& rec)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// the queue is destroyed after all threads are stopped, so also check the emulator state (remaining functions are discarded)
+	while (!m_stop && !Emu.IsStopped())
+	{
+		if (m_queue.empty())
+		{
+			m_cv.wait_for(lock, std::chrono::milliseconds(20));
+			continue;
+		}
+
+		const auto func = std::move(m_queue.front());
+		m_queue.pop_front();
+		depth--;
+
+		lock.unlock();
+
+		try
+		{
+			rec.compile(*func);
+			compiled++;
+		}
+		catch (const std::exception& e)
+		{
+			// the function will be interpreted
+			LOG_ERROR(SPU, "Compilation failed (function 0x%05x): %s", func->addr, e.what());
+		}
+
+		lock.lock();
+	}
 }
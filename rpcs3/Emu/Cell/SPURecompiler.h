@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Utilities/Thread.h"
 #include "Emu/CPU/CPUDecoder.h"
 #include "SPUAnalyser.h"
 
@@ -20,17 +21,60 @@ public:
 	virtual ~SPURecompilerBase() {};
 };
 
+// SPU function compile queue (compiles functions in background threads, must be global or PS3 process-local)
+class spu_compile_queue_t final
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	// Functions waiting for compilation
+	std::deque<std::shared_ptr<spu_function_t>> m_queue;
+
+	// Recompiler instance per worker thread
+	std::vector<std::shared_ptr<SPURecompilerBase>> m_recs;
+
+	// Worker threads (exit on emulation stop, joined in the destructor)
+	std::vector<std::shared_ptr<thread_ctrl>> m_workers;
+
+	bool m_stop = false;
+
+	void work(SPURecompilerBase& rec);
+
+public:
+	atomic_t<u32> depth{ 0 }; // number of functions in the queue
+	atomic_t<u32> compiled{ 0 }; // number of functions compiled
+	atomic_t<u64> interpreted_time{ 0 }; // time spent interpreting functions which were not compiled yet (in microseconds)
+
+	spu_compile_queue_t();
+	~spu_compile_queue_t();
+
+	// Add function to the queue (does nothing if already added)
+	void push(const std::shared_ptr<spu_function_t>& func);
+};
+
 // SPU Decoder instance (created per SPU thread)
 class SPURecompilerDecoder final : public CPUDecoder
 {
 public:
 	const std::shared_ptr<SPUDatabase> db; // associated SPU Analyser instance
 
-	const std::shared_ptr<SPURecompilerBase> rec; // assiciated SPU Recompiler instance
+	const std::shared_ptr<spu_compile_queue_t> queue; // associated compile queue
 
 	SPUThread& spu; // associated SPU Thread
 
+	std::vector<std::shared_ptr<spu_function_t>> m_entry_cache; // LS address / 4 -> analysed function (may be not registered in db if rejected as a duplicate)
+
+	std::vector<spu_jit_func_t> m_link_table; // LS address / 4 -> compiled function which can be entered directly (flushed with m_entry_cache)
+
+	u32 m_link = -1; // return address of the innermost function call (following linked functions stops there)
+
 	SPURecompilerDecoder(SPUThread& spu);
 
 	u32 DecodeMemory(const u32 address) override; // non-virtual override (to avoid virtual call whenever possible)
+
+	// Execute called function until it returns to the link address or the dispatcher must be left (returns PC)
+	u32 call(u32 link);
+
+	// Execute not compiled function using the fast interpreter until it leaves the function
+	void interpret(spu_function_t& func);
 };
@@ -18,6 +18,7 @@
 
 #include <cfenv>
 
+extern u64 get_system_time();
 extern u64 get_timebased_time();
 
 // defined here since SPUDisAsm.cpp doesn't exist
@@ -68,10 +69,24 @@ SPUThread::SPUThread(const std::string& name, u32 index)
 
 SPUThread::~SPUThread()
 {
+	// Complete DMA transfers (normally done in on_exit)
+	mfc_engine.stop();
+
+	if (llar_park_count)
+	{
+		LOG_NOTICE(SPU, "%s: GETLLAR polling loops parked %u times (%llu us)", get_name(), llar_park_count, llar_park_time);
+	}
+
 	// Deallocate Local Storage
 	vm::dealloc_verbose_nothrow(offset);
 }
 
+void SPUThread::on_exit()
+{
+	// The helper thread must be stopped before Emulator::Stop() finishes waiting for all threads
+	mfc_engine.stop();
+}
+
 bool SPUThread::is_paused() const
 {
 	if (CPUThread::is_paused())
@@ -100,35 +115,200 @@ void SPUThread::dump_info() const
 	CPUThread::dump_info();
 }
 
+// Time slice of SPU threads if the scheduler is enabled (in microseconds)
+const u64 g_spu_sched_slice = 1000;
+
+// Number of instructions (interpreter) or dispatches (recompiler) between time slice checks
+const u32 g_spu_sched_budget = 256;
+
+// Holds the execution slot of the SPU scheduler while SPU code is executed
+struct spu_sched_run_t
+{
+	SPUThread& spu;
+
+	spu_sched_run_t(SPUThread& spu)
+		: spu(spu)
+	{
+		spu.sched_acquire();
+	}
+
+	~spu_sched_run_t()
+	{
+		spu.sched_release();
+	}
+};
+
+// Releases the execution slot while the SPU thread may block
+struct spu_sched_sleep_t
+{
+	SPUThread& spu;
+
+	spu_sched_sleep_t(SPUThread& spu)
+		: spu(spu)
+	{
+		spu.sched_release();
+	}
+
+	~spu_sched_sleep_t()
+	{
+		// the thread is leaving SPU code if an exception is thrown
+		if (!std::uncaught_exception())
+		{
+			spu.sched_acquire();
+		}
+	}
+};
+
+spu_scheduler_t::spu_scheduler_t()
+	: workers(rpcs3::state.config.core.spu_workers.value())
+{
+	LOG_SUCCESS(SPU, "SPU scheduler: %u worker threads", workers);
+}
+
+spu_scheduler_t::~spu_scheduler_t()
+{
+	LOG_NOTICE(SPU, "SPU scheduler: %llu context switches", switches.load());
+}
+
+bool spu_scheduler_t::acquire(SPUThread& spu, s32 prio)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	const auto key = std::make_pair(prio, m_ticket++);
+
+	m_waiting.emplace(key);
+	waiting++;
+
+	while (m_running >= workers || *m_waiting.begin() != key)
+	{
+		if (spu.is_stopped() || Emu.IsStopped())
+		{
+			m_waiting.erase(key);
+			waiting--;
+			m_cv.notify_all();
+			return false;
+		}
+
+		// stopping the thread doesn't notify the scheduler
+		m_cv.wait_for(lock, std::chrono::milliseconds(10));
+	}
+
+	m_waiting.erase(key);
+	waiting--;
+	m_running++;
+	switches++;
+
+	// the next thread may take another free slot
+	m_cv.notify_all();
+	return true;
+}
+
+void spu_scheduler_t::release()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_running--;
+	m_cv.notify_all();
+}
+
+void SPUThread::sched_acquire()
+{
+	if (sched && !sched_slot)
+	{
+		const auto group = tg.lock();
+
+		sched_slot = sched->acquire(*this, group ? group->prio : 0);
+		sched_stamp = get_system_time();
+		sched_budget = g_spu_sched_budget;
+	}
+}
+
+void SPUThread::sched_release()
+{
+	if (sched_slot)
+	{
+		sched_slot = false;
+		sched->release();
+	}
+}
+
+void SPUThread::sched_check()
+{
+	sched_budget = g_spu_sched_budget;
+
+	// threads with the same or higher priority are first in the queue
+	if (sched_slot && sched->waiting && get_system_time() - sched_stamp >= g_spu_sched_slice)
+	{
+		sched_release();
+		sched_acquire();
+	}
+}
+
 void SPUThread::cpu_task()
 {
 	std::fesetround(FE_TOWARDZERO);
 
+	if (!sched && rpcs3::state.config.core.spu_workers.value())
+	{
+		sched = fxm::get_always<spu_scheduler_t>();
+	}
+
+	const spu_sched_run_t run(*this);
+
+	// the execution slot is released while the thread is paused
+	const auto check = [this]() -> bool
+	{
+		const spu_sched_sleep_t sleep(*this);
+
+		return check_status();
+	};
+
 	if (!custom_task && !m_dec)
 	{
 		// Select opcode table (TODO)
 		const auto& table = rpcs3::state.config.core.spu_decoder.value() == spu_decoder_type::interpreter_precise ? spu_interpreter::precise::g_spu_opcode_table : spu_interpreter::fast::g_spu_opcode_table;
 
+		if (!ls_decoded)
+		{
+			ls_decoded = std::make_unique<spu_decoded_ls_t>(table);
+		}
+
+		auto& decoded = *ls_decoded;
+
+		// LS could be modified externally while the thread was stopped
+		decoded.reset(*this);
+
 		// LS base address
 		const auto base = vm::_ptr<const u32>(offset);
 
 		while (true)
 		{
-			if (!m_state)
+			if (!m_state && !ls_code_dirty)
 			{
 				// read opcode
 				const u32 opcode = base[pc / 4];
 
 				// call interpreter function
-				table[opcode](*this, { opcode });
+				decoded[pc](*this, { opcode });
 
 				// next instruction
 				pc += 4;
 
+				if (sched && !--sched_budget)
+				{
+					sched_check();
+				}
+
 				continue;
 			}
 
-			if (check_status())
+			if (ls_code_dirty)
+			{
+				decoded.update(*this);
+				continue;
+			}
+
+			if (check())
 			{
 				return;
 			}
@@ -137,15 +317,23 @@ void SPUThread::cpu_task()
 
 	if (custom_task)
 	{
-		if (check_status()) return;
+		if (check()) return;
 
 		return custom_task(*this);
 	}
 
-	while (!m_state || !check_status())
+	// LS could be modified externally while the thread was stopped
+	ls_code_dirty = 1;
+
+	while (!m_state || !check())
 	{
 		// decode instruction using specified decoder
 		pc += m_dec->DecodeMemory(pc + offset);
+
+		if (sched && !--sched_budget)
+		{
+			sched_check();
+		}
 	}
 }
 
@@ -156,6 +344,10 @@ void SPUThread::init_regs()
 
 	ch_mfc_args = {};
 	mfc_queue.clear();
+	mfc_engine.sync();
+
+	llar_poll_addr = 0;
+	llar_poll_count = 0;
 
 	ch_tag_mask = 0;
 	ch_tag_stat.data.store({});
@@ -261,6 +453,184 @@ void SPUThread::fast_call(u32 ls_addr)
 	custom_task = std::move(old_task);
 }
 
+// Min size of transfers executed by the helper thread (smaller ones are only queued to keep the order)
+const u32 g_spu_mfc_async_size = 0x1000;
+
+// Copy 16-byte aligned data to main memory with non-temporal stores (it's unlikely to be read by the SPU again)
+static void spu_dma_copy_nt(void* dst, const void* src, u32 size)
+{
+	for (u32 i = 0; i < size; i += 16)
+	{
+		_mm_stream_si128(reinterpret_cast<__m128i*>(static_cast<u8*>(dst) + i), _mm_load_si128(reinterpret_cast<const __m128i*>(static_cast<const u8*>(src) + i)));
+	}
+
+	_mm_sfence();
+}
+
+static bool spu_tag_update_ready(u32 mode, u32 mask, u32 busy)
+{
+	switch (mode)
+	{
+	case MFC_TAG_UPDATE_ANY: return !mask || (mask & ~busy) != 0;
+	case MFC_TAG_UPDATE_ALL: return (mask & busy) == 0;
+	}
+
+	return true;
+}
+
+spu_mfc_engine_t::spu_mfc_engine_t(SPUThread& spu)
+	: m_spu(spu)
+{
+}
+
+spu_mfc_engine_t::~spu_mfc_engine_t()
+{
+	stop();
+}
+
+void spu_mfc_engine_t::push(u32 cmd, u32 eal, u32 lsa, u32 size, u32 tag)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_worker)
+	{
+		m_worker = thread_ctrl::spawn([this]() { return m_spu.get_name() + " DMA"; }, [this]() { work(); });
+	}
+
+	m_queue.push_back({ cmd, eal, lsa, size, tag });
+
+	if (!m_tag_count[tag]++)
+	{
+		busy |= 1 << tag;
+	}
+
+	m_cv.notify_one();
+}
+
+void spu_mfc_engine_t::sync()
+{
+	if (!busy)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_queue.empty())
+	{
+		m_done.wait(lock);
+	}
+}
+
+void spu_mfc_engine_t::update_tag_stat(u32 mode)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_tag_mask = m_spu.ch_tag_mask;
+
+	if (spu_tag_update_ready(mode, m_tag_mask, busy))
+	{
+		m_tag_update = MFC_TAG_UPDATE_IMMEDIATE;
+		m_spu.ch_tag_stat.set_value(m_tag_mask & ~busy);
+	}
+	else
+	{
+		// the helper thread sets the value
+		m_tag_update = mode;
+		m_spu.ch_tag_stat.data.store({});
+	}
+}
+
+void spu_mfc_engine_t::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_worker)
+		{
+			return;
+		}
+
+		m_stop = true;
+		m_cv.notify_one();
+	}
+
+	m_worker->join();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_worker.reset();
+	m_stop = false;
+}
+
+void spu_mfc_engine_t::work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop || !m_queue.empty())
+	{
+		if (m_queue.empty())
+		{
+			m_cv.wait(lock);
+			continue;
+		}
+
+		const transfer_t t = m_queue.front();
+
+		lock.unlock();
+
+		void* const ls = vm::base(m_spu.offset + t.lsa);
+		void* const mem = vm::base(t.eal);
+
+		if ((t.cmd & ~(MFC_BARRIER_MASK | MFC_FENCE_MASK)) == MFC_GET_CMD)
+		{
+			std::memcpy(ls, mem, t.size);
+
+			// LS is modified, the transfer isn't complete until the code is invalidated
+			m_spu.ls_code_notify(t.lsa, t.size);
+		}
+		else if (t.size >= g_spu_mfc_async_size && ((t.eal | t.lsa | t.size) & 0xf) == 0)
+		{
+			spu_dma_copy_nt(mem, ls, t.size);
+		}
+		else
+		{
+			std::memcpy(mem, ls, t.size);
+		}
+
+		lock.lock();
+
+		m_queue.pop_front();
+
+		if (!--m_tag_count[t.tag])
+		{
+			busy &= ~(1 << t.tag);
+		}
+
+		m_done.notify_all();
+
+		if (m_tag_update != MFC_TAG_UPDATE_IMMEDIATE && spu_tag_update_ready(m_tag_update, m_tag_mask, busy))
+		{
+			m_tag_update = MFC_TAG_UPDATE_IMMEDIATE;
+			m_spu.ch_tag_stat.push(m_tag_mask & ~busy);
+
+			if (spu_channel_t::notification_required)
+			{
+				lock.unlock();
+
+				{
+					// lock for reliable notification
+					std::lock_guard<std::mutex> spu_lock(m_spu.mutex);
+
+					m_spu.cv.notify_one();
+				}
+
+				lock.lock();
+			}
+		}
+	}
+}
+
 void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 {
 	if (cmd & (MFC_BARRIER_MASK | MFC_FENCE_MASK))
@@ -270,8 +640,13 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 
 	u32 eal = VM_CAST(args.ea);
 
+	SPUThread* target = nullptr; // SPU thread whose LS is accessed by eal
+
 	if (eal >= SYS_SPU_THREAD_BASE_LOW && m_type == CPU_THREAD_SPU) // SPU Thread Group MMIO (LS and SNR)
 	{
+		// MMIO access is performed after queued transfers
+		mfc_engine.sync();
+
 		const u32 index = (eal - SYS_SPU_THREAD_BASE_LOW) / SYS_SPU_THREAD_OFFSET; // thread number in group
 		const u32 offset = (eal - SYS_SPU_THREAD_BASE_LOW) % SYS_SPU_THREAD_OFFSET; // LS offset or MMIO register
 
@@ -284,6 +659,7 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 			if (offset + args.size - 1 < 0x40000) // LS access
 			{
 				eal = spu.offset + offset; // redirect access
+				target = &spu;
 			}
 			else if ((cmd & MFC_PUT_CMD) && args.size == 4 && (offset == SYS_SPU_THREAD_SNR1 || offset == SYS_SPU_THREAD_SNR2))
 			{
@@ -300,6 +676,18 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 			throw EXCEPTION("Invalid thread type (cmd=0x%x, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x)", cmd, args.lsa, args.ea, args.tag, args.size);
 		}
 	}
+	else if (m_type == CPU_THREAD_SPU)
+	{
+		const u32 type = cmd & ~(MFC_BARRIER_MASK | MFC_FENCE_MASK);
+
+		// large transfers are executed asynchronously, small ones are queued after them to keep the order
+		if ((args.size >= g_spu_mfc_async_size || mfc_engine.busy) && (type == MFC_PUT_CMD || type == MFC_PUTR_CMD || type == MFC_GET_CMD) && vm::check_addr(eal, args.size))
+		{
+			return mfc_engine.push(cmd, eal, args.lsa, args.size, args.tag);
+		}
+
+		mfc_engine.sync();
+	}
 
 	switch (cmd & ~(MFC_BARRIER_MASK | MFC_FENCE_MASK))
 	{
@@ -307,12 +695,19 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 	case MFC_PUTR_CMD:
 	{
 		std::memcpy(vm::base(eal), vm::base(offset + args.lsa), args.size);
+
+		if (target)
+		{
+			target->ls_code_notify(eal - target->offset, args.size);
+		}
+
 		return;
 	}
 
 	case MFC_GET_CMD:
 	{
 		std::memcpy(vm::base(offset + args.lsa), vm::base(eal), args.size);
+		ls_code_notify(args.lsa, args.size);
 		return;
 	}
 	}
@@ -338,27 +733,45 @@ void SPUThread::do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args)
 		be_t<u32> ea; // External Address Low
 	};
 
+	const auto list = vm::_ptr<list_element>(offset + list_addr);
+
 	for (u32 i = 0; i < list_size; i++)
 	{
-		auto rec = vm::ptr<list_element>::make(offset + list_addr + i * 8);
-
-		const u32 size = rec->ts;
-		const u32 addr = rec->ea;
+		u32 size = list[i].ts;
+		const u32 addr = list[i].ea;
 
 		if (size)
 		{
+			const u32 lsa = args.lsa | (addr & 0xf);
+
+			args.lsa += std::max<u32>(size, 16);
+
+			// coalesce following elements which continue both EA and LS ranges (up to the max transfer size)
+			while (i + 1 < list_size && !(list[i].sb & 0x8000) && size % 16 == 0)
+			{
+				const u32 next_size = list[i + 1].ts;
+				const u32 next_addr = list[i + 1].ea;
+
+				if (!next_size || next_size % 16 || next_addr != addr + size || size + next_size > 0x4000)
+				{
+					break;
+				}
+
+				i++;
+				size += next_size;
+				args.lsa += next_size;
+			}
+
 			spu_mfc_arg_t transfer;
 			transfer.ea = addr;
-			transfer.lsa = args.lsa | (addr & 0xf);
+			transfer.lsa = lsa;
 			transfer.tag = args.tag;
 			transfer.size = size;
 
 			do_dma_transfer(cmd & ~MFC_LIST_MASK, transfer);
-
-			args.lsa += std::max<u32>(size, 16);
 		}
 
-		if (rec->sb & 0x8000)
+		if (list[i].sb & 0x8000)
 		{
 			ch_stall_stat.set_value((1 << args.tag) | ch_stall_stat.get_value());
 
@@ -374,10 +787,45 @@ void SPUThread::do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args)
 	}
 }
 
+// Number of GETLLAR commands loading unchanged data required to detect a polling loop
+const u32 g_spu_llar_poll_count = 8;
+
+// Max waiting time (the waiting thread may poll other conditions, like the decrementer, after it)
+const u64 g_spu_llar_park_max = 1000;
+
+void SPUThread::park_getllar(u32 raddr)
+{
+	const spu_sched_sleep_t sleep(*this);
+
+	const u64 stamp = get_system_time();
+	const u32 mbox_count = ch_in_mbox.get_count();
+
+	// the predicate is also polled periodically, because plain writes don't notify waiters
+	vm::wait_op(*this, raddr, 128, [&]()
+	{
+		return std::memcmp(vm::base(raddr), llar_poll_data.data(), 128) != 0 ||
+			get_events() ||
+			ch_in_mbox.get_count() != mbox_count ||
+			ch_snr1.get_count() ||
+			ch_snr2.get_count() ||
+			is_stopped() ||
+			get_system_time() - stamp >= g_spu_llar_park_max;
+	});
+
+	llar_park_time += get_system_time() - stamp;
+	llar_park_count++;
+}
+
 void SPUThread::process_mfc_cmd(u32 cmd)
 {
 	LOG_TRACE(SPU, "DMA %s: cmd=0x%x, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x", get_mfc_cmd_name(cmd), cmd, ch_mfc_args.lsa, ch_mfc_args.ea, ch_mfc_args.tag, ch_mfc_args.size);
 
+	if (cmd != MFC_GETLLAR_CMD)
+	{
+		// not a polling loop
+		llar_poll_count = 0;
+	}
+
 	switch (cmd)
 	{
 	case MFC_PUT_CMD:
@@ -415,7 +863,26 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 
 		const u32 raddr = VM_CAST(ch_mfc_args.ea);
 
+		mfc_engine.sync();
+
+		if (llar_poll_count >= g_spu_llar_poll_count && raddr == llar_poll_addr && std::memcmp(vm::base(raddr), llar_poll_data.data(), 128) == 0)
+		{
+			park_getllar(raddr);
+		}
+
 		vm::reservation_acquire(vm::base(offset + ch_mfc_args.lsa), raddr, 128);
+		ls_code_notify(ch_mfc_args.lsa, 128);
+
+		if (raddr == llar_poll_addr && std::memcmp(vm::base(offset + ch_mfc_args.lsa), llar_poll_data.data(), 128) == 0)
+		{
+			llar_poll_count++;
+		}
+		else
+		{
+			llar_poll_addr = raddr;
+			llar_poll_count = 0;
+			std::memcpy(llar_poll_data.data(), vm::base(offset + ch_mfc_args.lsa), 128);
+		}
 
 		if (last_raddr)
 		{
@@ -434,6 +901,8 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 			break;
 		}
 
+		mfc_engine.sync();
+
 		if (vm::reservation_update(VM_CAST(ch_mfc_args.ea), vm::base(offset + ch_mfc_args.lsa), 128))
 		{
 			if (last_raddr == 0)
@@ -466,6 +935,8 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 			break;
 		}
 
+		mfc_engine.sync();
+
 		vm::reservation_op(VM_CAST(ch_mfc_args.ea), 128, [this]()
 		{
 			std::memcpy(vm::base_priv(VM_CAST(ch_mfc_args.ea)), vm::base(offset + ch_mfc_args.lsa), 128);
@@ -489,10 +960,13 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 	case MFC_BARRIER_CMD:
 	case MFC_EIEIO_CMD:
 	case MFC_SYNC_CMD:
-		LOG_WARNING(SPU, "process_mfc_cmd: Sync channel '%s' ignored. (cmd=0x%x, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x)",
-			get_mfc_cmd_name(cmd), cmd, ch_mfc_args.lsa, ch_mfc_args.ea, ch_mfc_args.tag, ch_mfc_args.size);
+	{
+		// queued transfers are executed in order
+		mfc_engine.sync();
+		_mm_mfence();
 		return;
 	}
+	}
 
 	throw EXCEPTION("Unknown command %s (cmd=0x%x, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x)",
 		get_mfc_cmd_name(cmd), cmd, ch_mfc_args.lsa, ch_mfc_args.ea, ch_mfc_args.tag, ch_mfc_args.size);
@@ -575,6 +1049,12 @@ u32 SPUThread::get_ch_count(u32 ch)
 {
 	LOG_TRACE(SPU, "get_ch_count(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 
+	// channel count polling loops may be never interrupted otherwise
+	if (sched && !--sched_budget)
+	{
+		sched_check();
+	}
+
 	switch (ch)
 	{
 	//case MFC_Cmd:             return 16;
@@ -599,6 +1079,30 @@ u32 SPUThread::get_ch_value(u32 ch)
 {
 	LOG_TRACE(SPU, "get_ch_value(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 
+	if (sched_slot) switch (ch)
+	{
+	case SPU_RdInMbox:
+	case MFC_RdTagStat:
+	case SPU_RdSigNotify1:
+	case SPU_RdSigNotify2:
+	case MFC_RdAtomicStat:
+	case MFC_RdListStallStat:
+	case SPU_RdEventStat:
+	{
+		u32 value;
+
+		if (try_get_ch_value(ch, value))
+		{
+			return value;
+		}
+
+		// release the execution slot (the recursive call may block)
+		const spu_sched_sleep_t sleep(*this);
+
+		return get_ch_value(ch);
+	}
+	}
+
 	auto read_channel = [this](spu_channel_t& channel) -> u32
 	{
 		std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
@@ -756,10 +1260,105 @@ u32 SPUThread::get_ch_value(u32 ch)
 	throw EXCEPTION("Unknown/illegal channel (ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 }
 
+bool SPUThread::try_get_ch_value(u32 ch, u32& out)
+{
+	bool result = false;
+
+	switch (ch)
+	{
+	case SPU_RdInMbox:
+	{
+		u32 count;
+
+		std::tie(result, out, count) = ch_in_mbox.try_pop();
+
+		if (result && count + 1 == 4 /* SPU_IN_MBOX_THRESHOLD */) // TODO: check this
+		{
+			int_ctrl[2].set(SPU_INT2_STAT_SPU_MAILBOX_THRESHOLD_INT);
+		}
+
+		return result;
+	}
+
+	case MFC_RdTagStat: std::tie(result, out) = ch_tag_stat.try_pop(); return result;
+	case SPU_RdSigNotify1: std::tie(result, out) = ch_snr1.try_pop(); return result;
+	case SPU_RdSigNotify2: std::tie(result, out) = ch_snr2.try_pop(); return result;
+	case MFC_RdAtomicStat: std::tie(result, out) = ch_atomic_stat.try_pop(); return result;
+	case MFC_RdListStallStat: std::tie(result, out) = ch_stall_stat.try_pop(); return result;
+
+	case SPU_RdEventStat:
+	{
+		// return immediately only if events are pending
+		return get_events() && (out = get_events(true)) != 0;
+	}
+
+	case MFC_RdTagMask:
+	case SPU_RdDec:
+	case SPU_RdEventMask:
+	case SPU_RdMachStat:
+	{
+		out = get_ch_value(ch);
+		return true;
+	}
+	}
+
+	return false;
+}
+
+bool SPUThread::try_set_ch_value(u32 ch, u32 value)
+{
+	switch (ch)
+	{
+	case SPU_WrOutMbox:
+	{
+		return ch_out_mbox.try_push(value);
+	}
+
+	case MFC_WrTagMask:
+	case MFC_WrTagUpdate:
+	case MFC_EAH:
+	case MFC_EAL:
+	case SPU_WrDec:
+	{
+		set_ch_value(ch, value);
+		return true;
+	}
+
+	case MFC_LSA:
+	case MFC_Size:
+	case MFC_TagID:
+	{
+		if ((ch == MFC_LSA && value >= 0x40000) || (ch == MFC_Size && value > 16 * 1024) || (ch == MFC_TagID && value >= 32))
+		{
+			// invalid value (set_ch_value() reports the error)
+			return false;
+		}
+
+		set_ch_value(ch, value);
+		return true;
+	}
+	}
+
+	return false;
+}
+
 void SPUThread::set_ch_value(u32 ch, u32 value)
 {
 	LOG_TRACE(SPU, "set_ch_value(ch=%d [%s], value=0x%x)", ch, ch < 128 ? spu_ch_name[ch] : "???", value);
 
+	if (sched_slot && (ch == SPU_WrOutMbox || ch == SPU_WrOutIntrMbox))
+	{
+		if (try_set_ch_value(ch, value))
+		{
+			return;
+		}
+
+		// release the execution slot (the recursive call may block)
+		const spu_sched_sleep_t sleep(*this);
+
+		return set_ch_value(ch, value);
+	}
+
 	switch (ch)
 	{
 	//case SPU_WrSRR0:
@@ -824,13 +1423,11 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					return ch_in_mbox.set_values(1, CELL_ENOTCONN); // TODO: check error passing
 				}
 
-				if (queue->events.size() >= queue->size)
+				if (!queue->push(SYS_SPU_THREAD_EVENT_USER_KEY, m_id, ((u64)spup << 32) | (value & 0x00ffffff), data))
 				{
 					return ch_in_mbox.set_values(1, CELL_EBUSY);
 				}
 
-				queue->push(lv2_lock, SYS_SPU_THREAD_EVENT_USER_KEY, m_id, ((u64)spup << 32) | (value & 0x00ffffff), data);
-
 				return ch_in_mbox.set_values(1, CELL_OK);
 			}
 			else if (code < 128)
@@ -861,20 +1458,18 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 				}
 
 				// TODO: check passing spup value
-				if (queue->events.size() >= queue->size)
+				if (!queue->push(SYS_SPU_THREAD_EVENT_USER_KEY, m_id, ((u64)spup << 32) | (value & 0x00ffffff), data))
 				{
 					LOG_WARNING(SPU, "sys_spu_thread_throw_event(spup=%d, data0=0x%x, data1=0x%x) failed (queue is full)", spup, (value & 0x00ffffff), data);
-					return;
 				}
 
-				queue->push(lv2_lock, SYS_SPU_THREAD_EVENT_USER_KEY, m_id, ((u64)spup << 32) | (value & 0x00ffffff), data);
 				return;
 			}
 			else if (code == 128)
 			{
 				/* ===== sys_event_flag_set_bit ===== */
 
-				LV2_LOCK;
+				LV2_DEFER_LOCK;
 
 				const u32 flag = value & 0xffffff;
 
@@ -899,7 +1494,7 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 				LOG_TRACE(SPU, "sys_event_flag_set_bit(id=%d, value=0x%x (flag=%d))", data, value, flag);
 
-				const auto eflag = idm::get<lv2_event_flag_t>(data);
+				const auto eflag = lv2_lock_object<lv2_event_flag_t>(data, lv2_lock);
 
 				if (!eflag)
 				{
@@ -920,7 +1515,7 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			{
 				/* ===== sys_event_flag_set_bit_impatient ===== */
 
-				LV2_LOCK;
+				LV2_DEFER_LOCK;
 
 				const u32 flag = value & 0xffffff;
 
@@ -940,7 +1535,7 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 				LOG_TRACE(SPU, "sys_event_flag_set_bit_impatient(id=%d, value=0x%x (flag=%d))", data, value, flag);
 
-				const auto eflag = idm::get<lv2_event_flag_t>(data);
+				const auto eflag = lv2_lock_object<lv2_event_flag_t>(data, lv2_lock);
 
 				if (!eflag)
 				{
@@ -1001,7 +1596,7 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 	case MFC_WrTagUpdate:
 	{
-		ch_tag_stat.set_value(ch_tag_mask); // hack
+		mfc_engine.update_tag_stat(value);
 		return;
 	}
 
@@ -1136,6 +1731,11 @@ void SPUThread::stop_and_signal(u32 code)
 {
 	LOG_TRACE(SPU, "stop_and_signal(code=0x%x)", code);
 
+	// syscalls may block
+	const spu_sched_sleep_t sleep(*this);
+
+	mfc_engine.sync();
+
 	if (m_type == CPU_THREAD_RAW_SPU)
 	{
 		status.atomic_op([code](u32& status)
@@ -1261,30 +1861,52 @@ void SPUThread::stop_and_signal(u32 code)
 			throw EXCEPTION("Unexpected SPU Thread Group state (%d)", group->state);
 		}
 
-		if (queue->events.size())
-		{
-			auto& event = queue->events.front();
-			ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(std::get<1>(event)), static_cast<u32>(std::get<2>(event)), static_cast<u32>(std::get<3>(event)));
+		// LV2_LOCK is released while waiting on the event queue lock
+		lv2_lock.unlock();
 
-			queue->events.pop_front();
-		}
-		else
 		{
-			// add waiter; protocol is ignored in current implementation
-			sleep_queue_entry_t waiter(*this, queue->sq);
+			lv2_lock_t queue_lock(queue->lock);
+
+			// register before checking for events, so push() will notify this thread
+			lv2_event_queue_t::receiver_t receiver(*queue);
 
-			// wait on the event queue
-			while (!unsignal())
+			if (idm::get<lv2_event_queue_t>(queue->id) != queue)
 			{
-				CHECK_EMU_STATUS;
+				// destroyed before its lock was acquired
+				ch_in_mbox.set_values(1, CELL_ECANCELED);
+			}
+			else
+			{
+				// threads already waiting get events first
+				queue->notify(queue_lock);
 
-				if (is_stopped()) throw CPUThreadStop{};
+				lv2_event_queue_t::event_type event;
 
-				cv.wait(lv2_lock);
-			}
+				if (queue->pop(queue_lock, event))
+				{
+					ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(std::get<1>(event)), static_cast<u32>(std::get<2>(event)), static_cast<u32>(std::get<3>(event)));
+				}
+				else
+				{
+					// add waiter; protocol is ignored in current implementation
+					sleep_queue_entry_t waiter(*this, queue->sq);
+
+					// wait on the event queue
+					while (!unsignal())
+					{
+						CHECK_EMU_STATUS;
+
+						if (is_stopped()) throw CPUThreadStop{};
 
-			// event data must be set by push()
+						cv.wait(queue_lock);
+					}
+
+					// event data must be set by push()
+				}
+			}
 		}
+
+		lv2_lock.lock();
 		
 		// restore thread group status
 		if (group->state == SPU_THREAD_GROUP_STATUS_WAITING)
@@ -1391,6 +2013,8 @@ void SPUThread::halt()
 {
 	LOG_TRACE(SPU, "halt()");
 
+	mfc_engine.sync();
+
 	if (m_type == CPU_THREAD_RAW_SPU)
 	{
 		status.atomic_op([](u32& status)
@@ -8,6 +8,7 @@
 struct lv2_event_queue_t;
 struct lv2_spu_group_t;
 struct lv2_int_tag_t;
+class spu_decoded_ls_t;
 
 // SPU Channels
 enum : u32
@@ -526,6 +527,83 @@ public:
 	}
 };
 
+class SPUThread;
+
+// Limits the number of SPU threads executing SPU code simultaneously ("SPU Worker Threads" option).
+// The execution slot is released while the thread may block and on time slice expiry if other threads are waiting.
+class spu_scheduler_t final
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	std::set<std::pair<s32, u64>> m_waiting; // (priority, ticket) of threads waiting for a slot
+	u64 m_ticket = 0;
+	u32 m_running = 0; // number of threads holding a slot
+
+public:
+	const u32 workers; // number of slots
+
+	atomic_t<u32> waiting{ 0 }; // number of threads waiting for a slot
+	atomic_t<u64> switches{ 0 }; // number of acquired slots
+
+	spu_scheduler_t();
+	~spu_scheduler_t();
+
+	// Wait for a slot in priority order (returns false if the thread was stopped while waiting)
+	bool acquire(SPUThread& spu, s32 prio);
+
+	void release();
+};
+
+// MFC DMA queue of SPU thread (executes transfers in a helper thread while the SPU keeps running)
+class spu_mfc_engine_t final
+{
+	struct transfer_t
+	{
+		u32 cmd;
+		u32 eal;
+		u32 lsa;
+		u32 size;
+		u32 tag;
+	};
+
+	SPUThread& m_spu;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv; // signaled when a transfer is added or the engine is stopped
+	std::condition_variable m_done; // signaled when a transfer is completed
+
+	std::deque<transfer_t> m_queue; // transfers in order of execution (the first one is being executed)
+	std::array<u32, 32> m_tag_count{}; // number of queued transfers per tag group
+
+	u32 m_tag_update = MFC_TAG_UPDATE_IMMEDIATE; // pending MFC_WrTagUpdate request
+	u32 m_tag_mask = 0; // tag mask of the pending request
+
+	std::shared_ptr<thread_ctrl> m_worker; // started on first use, stopped when the SPU thread exits
+
+	bool m_stop = false;
+
+	void work();
+
+public:
+	atomic_t<u32> busy{ 0 }; // tag groups which have incomplete transfers
+
+	spu_mfc_engine_t(SPUThread& spu);
+	~spu_mfc_engine_t();
+
+	// Add main memory transfer (GET, PUT or PUTR)
+	void push(u32 cmd, u32 eal, u32 lsa, u32 size, u32 tag);
+
+	// Wait for all queued transfers
+	void sync();
+
+	// Process MFC_WrTagUpdate (ch_tag_stat is set immediately or when the request is satisfied)
+	void update_tag_stat(u32 mode);
+
+	// Complete queued transfers and stop the helper thread (it's started again by the next transfer)
+	void stop();
+};
+
 class SPUThread : public CPUThread
 {
 	friend class SPURecompilerDecoder;
@@ -541,6 +619,8 @@ public:
 
 	std::vector<std::pair<u32, spu_mfc_arg_t>> mfc_queue; // Only used for stalled list transfers
 
+	spu_mfc_engine_t mfc_engine{ *this }; // Transfers not performed immediately
+
 	u32 ch_tag_mask;
 	spu_channel_t ch_tag_stat;
 	spu_channel_t ch_stall_stat;
@@ -560,6 +640,17 @@ public:
 	atomic_t<u32> ch_event_stat;
 	u32 last_raddr; // Last Reservation Address (0 if not set)
 
+	u32 llar_poll_addr; // Address of repeated GETLLAR commands (not interrupted by other MFC commands)
+	u32 llar_poll_count; // Number of repeated GETLLAR commands which loaded unchanged data
+	std::array<v128, 8> llar_poll_data; // Data loaded by the last GETLLAR command
+	u64 llar_park_time = 0; // Total time spent waiting in detected GETLLAR polling loops (in microseconds)
+	u32 llar_park_count = 0; // Number of such waits
+
+	std::shared_ptr<spu_scheduler_t> sched; // SPU scheduler (not set if disabled)
+	bool sched_slot = false; // set if the thread holds an execution slot
+	u64 sched_stamp = 0; // time when the slot was acquired
+	u32 sched_budget = 0; // number of instructions or dispatches until the next time slice check
+
 	u64 ch_dec_start_timestamp; // timestamp of writing decrementer value
 	u32 ch_dec_value; // written decrementer value
 
@@ -578,6 +669,38 @@ public:
 	const u32 index; // SPU index
 	const u32 offset; // SPU LS offset
 
+	std::array<atomic_t<u64>, 0x40000 / 128 / 64> ls_code_map{}; // LS lines (128 bytes) occupied by functions in the recompiler entry cache or decoded by the interpreter
+	std::array<atomic_t<u64>, 0x40000 / 128 / 64> ls_dirty_map{}; // LS lines from ls_code_map which were modified (used by the interpreter)
+	atomic_t<u32> ls_code_dirty{ 0 }; // set if a line in ls_code_map was modified (the entry cache must be flushed)
+
+	std::unique_ptr<spu_decoded_ls_t> ls_decoded; // pre-decoded LS (interpreter)
+
+	// Check LS modification (called on DMA and other writes not performed by SPU instructions, possibly from another thread)
+	void ls_code_notify(u32 lsa, u32 size)
+	{
+		// the LS write must be visible before ls_code_map is read (see spu_decoded_ls_t::decode)
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		for (u32 i = lsa / 128; i <= (lsa + size - 1) / 128 && i < 0x40000 / 128; i++)
+		{
+			if (ls_code_map[i / 64] & (1ull << (i % 64)))
+			{
+				ls_dirty_map[i / 64] |= 1ull << (i % 64);
+				ls_code_dirty = 1;
+			}
+		}
+	}
+
+	// Check 16-byte store to LS
+	void ls_code_store(u32 lsa)
+	{
+		if (ls_code_map[lsa / 128 / 64] & (1ull << (lsa / 128 % 64)))
+		{
+			ls_dirty_map[lsa / 128 / 64] |= 1ull << (lsa / 128 % 64);
+			ls_code_dirty = 1;
+		}
+	}
+
 	void push_snr(u32 number, u32 value)
 	{
 		// get channel
@@ -607,6 +730,11 @@ public:
 	void do_dma_transfer(u32 cmd, spu_mfc_arg_t args);
 	void do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args);
 	void process_mfc_cmd(u32 cmd);
+	void park_getllar(u32 raddr); // wait until the data at raddr is changed (or something else may need attention)
+
+	void sched_acquire(); // wait for an execution slot (if the scheduler is enabled)
+	void sched_release();
+	void sched_check(); // switch to another thread if the time slice expired
 
 	u32 get_events(bool waiting = false);
 	void set_events(u32 mask);
@@ -614,6 +742,8 @@ public:
 	u32 get_ch_count(u32 ch);
 	u32 get_ch_value(u32 ch);
 	void set_ch_value(u32 ch, u32 value);
+	bool try_get_ch_value(u32 ch, u32& out); // non-blocking read (returns false if get_ch_value() must be used)
+	bool try_set_ch_value(u32 ch, u32 value); // non-blocking write (returns false if set_ch_value() must be used)
 
 	void stop_and_signal(u32 code);
 	void halt();
@@ -634,6 +764,7 @@ public:
 	{
 		m_addr_to_hle_function_map[addr] = function;
 		_ref<u32>(addr) = 0x00000003; // STOP 3
+		ls_code_notify(addr, 4);
 	}
 
 	void UnregisterHleFunction(u32 addr)
@@ -663,6 +794,8 @@ public:
 protected:
 	SPUThread(CPUThreadType type, const std::string& name, u32 index, u32 offset);
 
+	virtual void on_exit() override;
+
 public:
 	SPUThread(const std::string& name, u32 index);
 	virtual ~SPUThread() override;
@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include "Emu/Memory/Memory.h"
 #include "vfsLocalFile.h"
 
 vfsLocalFile::vfsLocalFile(vfsDevice* device) : vfsFileBase(device)
@@ -30,6 +31,8 @@ u64 vfsLocalFile::Write(const void* src, u64 size)
 
 u64 vfsLocalFile::Read(void* dst, u64 size)
 {
+	vm::host_write_notify(dst, size);
+
 	return m_file.read(dst, size);
 }
 
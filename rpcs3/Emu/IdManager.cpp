@@ -3,9 +3,9 @@
 
 namespace idm
 {
-	shared_mutex g_mutex;
+	std::mutex g_mutex;
 
-	idm::map_t g_map;
+	std::array<shard_t, shard_count> g_shards;
 
 	u32 g_last_raw_id = 0;
 
@@ -14,49 +14,116 @@ namespace idm
 
 namespace fxm
 {
-	shared_mutex g_mutex;
+	std::mutex g_mutex;
 
-	fxm::map_t g_map;
+	// All slots allocated (never freed, addresses must be stable)
+	std::deque<slot_t> g_slots;
 }
 
 void idm::clear()
 {
-	std::lock_guard<shared_mutex> lock(g_mutex);
+	std::lock_guard<std::mutex> lock(g_mutex);
 
-	// Call recorded finalization functions for all IDs
-	for (auto& id : idm::map_t(std::move(g_map)))
+	std::vector<idm::map_t> maps;
+
+	for (auto& shard : g_shards)
 	{
-		(*id.second.type_index)(id.second.data.get());
+		std::lock_guard<shared_mutex> shard_lock(shard.mutex);
+
+		maps.emplace_back(std::move(shard.map));
+
+		shard.map.clear();
+	}
+
+	// Call recorded finalization functions for all IDs (except reserved)
+	for (auto& map : maps)
+	{
+		for (auto& id : map)
+		{
+			if (id.second.data)
+			{
+				(*id.second.type_index)(id.second.data.get());
+			}
+		}
 	}
 
 	g_last_raw_id = 0;
 }
 
+u32 idm::reserve(id_type_index_t type, const std::type_info& info, u32(*next_id)(u32))
+{
+	// ID allocation lock (lookups only lock the shard, the object is created after it's released)
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	for (u32 raw_id = g_last_raw_id; (raw_id = next_id(raw_id)); /**/)
+	{
+		auto& shard = get_shard(raw_id);
+
+		std::lock_guard<shared_mutex> shard_lock(shard.mutex);
+
+		if (!shard.map.emplace(raw_id, id_data_t(type, info)).second) continue;
+
+		if (raw_id < 0x80000000) g_last_raw_id = raw_id;
+
+		return raw_id;
+	}
+
+	return 0;
+}
+
+void idm::publish(u32 raw_id, std::shared_ptr<void> ptr)
+{
+	auto& shard = get_shard(raw_id);
+
+	std::lock_guard<shared_mutex> lock(shard.mutex);
+
+	const auto found = shard.map.find(raw_id);
+
+	// may be removed by clear()
+	if (found != shard.map.end() && !found->second.data)
+	{
+		if (ptr)
+		{
+			found->second.data = std::move(ptr);
+		}
+		else
+		{
+			shard.map.erase(found);
+		}
+	}
+}
+
 bool idm::check(u32 in_id, id_type_index_t type)
 {
-	reader_lock lock(g_mutex);
+	auto& shard = get_shard(in_id);
 
-	const auto found = g_map.find(in_id);
+	reader_lock lock(shard.mutex);
 
-	return found != g_map.end() && found->second.type_index == type;
+	const auto found = shard.map.find(in_id);
+
+	return found != shard.map.end() && found->second.type_index == type && found->second.data;
 }
 
 const std::type_info* idm::get_type(u32 raw_id)
 {
-	reader_lock lock(g_mutex);
+	auto& shard = get_shard(raw_id);
+
+	reader_lock lock(shard.mutex);
 
-	const auto found = g_map.find(raw_id);
+	const auto found = shard.map.find(raw_id);
 
-	return found == g_map.end() ? nullptr : found->second.info;
+	return found == shard.map.end() || !found->second.data ? nullptr : found->second.info;
 }
 
 std::shared_ptr<void> idm::get(u32 in_id, id_type_index_t type)
 {
-	reader_lock lock(g_mutex);
+	auto& shard = get_shard(in_id);
+
+	reader_lock lock(shard.mutex);
 
-	const auto found = g_map.find(in_id);
+	const auto found = shard.map.find(in_id);
 
-	if (found == g_map.end() || found->second.type_index != type)
+	if (found == shard.map.end() || found->second.type_index != type)
 	{
 		return nullptr;
 	}
@@ -66,15 +133,18 @@ std::shared_ptr<void> idm::get(u32 in_id, id_type_index_t type)
 
 idm::map_t idm::get_all(id_type_index_t type)
 {
-	reader_lock lock(g_mutex);
-
 	idm::map_t result;
 
-	for (auto& id : g_map)
+	for (auto& shard : g_shards)
 	{
-		if (id.second.type_index == type)
+		reader_lock lock(shard.mutex);
+
+		for (auto& id : shard.map)
 		{
-			result.insert(id);
+			if (id.second.type_index == type && id.second.data)
+			{
+				result.insert(id);
+			}
 		}
 	}
 
@@ -83,33 +153,38 @@ idm::map_t idm::get_all(id_type_index_t type)
 
 std::shared_ptr<void> idm::withdraw(u32 in_id, id_type_index_t type)
 {
-	std::lock_guard<shared_mutex> lock(g_mutex);
+	auto& shard = get_shard(in_id);
+
+	std::lock_guard<shared_mutex> lock(shard.mutex);
 
-	const auto found = g_map.find(in_id);
+	const auto found = shard.map.find(in_id);
 
-	if (found == g_map.end() || found->second.type_index != type)
+	if (found == shard.map.end() || found->second.type_index != type || !found->second.data)
 	{
 		return nullptr;
 	}
 
 	auto ptr = std::move(found->second.data);
 
-	g_map.erase(found);
+	shard.map.erase(found);
 
 	return ptr;
 }
 
 u32 idm::get_count(id_type_index_t type)
 {
-	reader_lock lock(g_mutex);
-
 	u32 result = 0;
 
-	for (auto& id : g_map)
+	for (auto& shard : g_shards)
 	{
-		if (id.second.type_index == type)
+		reader_lock lock(shard.mutex);
+
+		for (auto& id : shard.map)
 		{
-			result++;
+			if (id.second.type_index == type && id.second.data)
+			{
+				result++;
+			}
 		}
 	}
 
@@ -117,40 +192,32 @@ u32 idm::get_count(id_type_index_t type)
 }
 
 
-void fxm::clear()
-{
-	std::lock_guard<shared_mutex> lock(g_mutex);
-
-	// Call recorded finalization functions for all IDs
-	for (auto& id : fxm::map_t(std::move(g_map)))
-	{
-		if (id.second) (*id.first)(id.second.get());
-	}
-}
-
-bool fxm::check(id_type_index_t type)
+fxm::slot_t& fxm::add_slot(id_type_index_t type)
 {
-	reader_lock lock(g_mutex);
+	std::lock_guard<std::mutex> lock(g_mutex);
 
-	const auto found = g_map.find(type);
+	g_slots.emplace_back(type);
 
-	return found != g_map.end() && found->second;
+	return g_slots.back();
 }
 
-std::shared_ptr<void> fxm::get(id_type_index_t type)
+void fxm::clear()
 {
-	reader_lock lock(g_mutex);
+	std::lock_guard<std::mutex> lock(g_mutex);
 
-	const auto found = g_map.find(type);
-
-	return found != g_map.end() ? found->second : nullptr;
+	// Call recorded finalization functions for all objects
+	for (auto& slot : g_slots)
+	{
+		if (auto ptr = std::atomic_exchange(&slot.data, std::shared_ptr<void>()))
+		{
+			(*slot.type_index)(ptr.get());
+		}
+	}
 }
 
-std::shared_ptr<void> fxm::withdraw(id_type_index_t type)
+std::shared_ptr<void> fxm::withdraw(slot_t& slot)
 {
-	std::unique_lock<shared_mutex> lock(g_mutex);
-
-	const auto found = g_map.find(type);
+	std::lock_guard<std::mutex> lock(g_mutex);
 
-	return found != g_map.end() ? std::move(found->second) : nullptr;
+	return std::atomic_exchange(&slot.data, std::shared_ptr<void>());
 }
@@ -69,7 +69,7 @@ namespace idm
 {
 	struct id_data_t final
 	{
-		std::shared_ptr<void> data;
+		std::shared_ptr<void> data; // nullptr if the ID is reserved and the object is being created
 		const std::type_info* info;
 		id_type_index_t type_index;
 
@@ -79,6 +79,13 @@ namespace idm
 			, type_index(get_id_type_index<T>())
 		{
 		}
+
+		// reserved ID
+		id_data_t(id_type_index_t type_index, const std::type_info& info)
+			: info(&info)
+			, type_index(type_index)
+		{
+		}
 	};
 
 	// Custom hasher for ID values (map to itself)
@@ -92,6 +99,24 @@ namespace idm
 
 	using map_t = std::unordered_map<u32, id_data_t, id_hash_t>;
 
+	// Number of ID map shards (power of 2), IDs are distributed by their lower bits
+	// so lookups of different IDs don't contend on the same lock
+	const u32 shard_count = 32;
+
+	struct alignas(64) shard_t final
+	{
+		shared_mutex mutex;
+		map_t map;
+	};
+
+	// Get the shard containing specified mapped id
+	inline shard_t& get_shard(u32 raw_id)
+	{
+		extern std::array<shard_t, shard_count> g_shards;
+
+		return g_shards[raw_id % shard_count];
+	}
+
 	// Can be called from the constructor called through make() or make_ptr() to get the ID of the object being created
 	inline u32 get_last_id()
 	{
@@ -116,33 +141,46 @@ namespace idm
 	// Check if an ID exists and return its type or nullptr
 	const std::type_info* get_type(u32 raw_id);
 
+	// Internal (reserve free mapped id, returns 0 if out of IDs)
+	u32 reserve(id_type_index_t type, const std::type_info& info, u32(*next_id)(u32));
+
+	// Internal (set the object for the reserved id or release it if ptr is nullptr)
+	void publish(u32 raw_id, std::shared_ptr<void> ptr);
+
 	// Internal
 	template<typename T, typename Ptr>
 	std::shared_ptr<T> add(Ptr&& get_ptr)
 	{
-		extern shared_mutex g_mutex;
-		extern idm::map_t g_map;
-		extern u32 g_last_raw_id;
 		extern thread_local u32 g_tls_last_id;
 
-		std::lock_guard<shared_mutex> lock(g_mutex);
+		const u32 raw_id = reserve(get_id_type_index<T>(), typeid(T), &id_traits<T>::next_id);
 
-		for (u32 raw_id = g_last_raw_id; (raw_id = id_traits<T>::next_id(raw_id)); /**/)
+		if (!raw_id)
 		{
-			if (g_map.find(raw_id) != g_map.end()) continue;
+			return nullptr;
+		}
 
-			g_tls_last_id = id_traits<T>::out_id(raw_id);
+		g_tls_last_id = id_traits<T>::out_id(raw_id);
 
-			std::shared_ptr<T> ptr = get_ptr();
+		// the object is created without any lock held, the reserved ID isn't visible until published
+		std::shared_ptr<T> ptr;
 
-			g_map.emplace(raw_id, id_data_t(ptr));
+		try
+		{
+			ptr = get_ptr();
+		}
+		catch (...)
+		{
+			publish(raw_id, nullptr);
+			throw;
+		}
 
-			if (raw_id < 0x80000000) g_last_raw_id = raw_id;
+		publish(raw_id, ptr);
 
-			return ptr;
-		}
+		// restore the value (the constructor could create other IDs)
+		g_tls_last_id = id_traits<T>::out_id(raw_id);
 
-		return nullptr;
+		return ptr;
 	}
 
 	// Add a new ID of specified type with specified constructor arguments (returns object or nullptr)
@@ -285,16 +323,29 @@ namespace idm
 // object are deleted when the emulation is stopped
 namespace fxm
 {
-	// Custom hasher for aligned pointer values
-	struct hash_t final
+	// Object slot of specified type
+	struct slot_t final
 	{
-		std::size_t operator()(id_type_index_t value) const
+		std::shared_ptr<void> data; // read with std::atomic_load, modified under g_mutex
+		const id_type_index_t type_index;
+
+		slot_t(id_type_index_t type_index)
+			: type_index(type_index)
 		{
-			return reinterpret_cast<std::size_t>(value) >> 3;
 		}
 	};
 
-	using map_t = std::unordered_map<id_type_index_t, std::shared_ptr<void>, hash_t>;
+	// Internal (allocate the slot for clear())
+	slot_t& add_slot(id_type_index_t type);
+
+	// Get the slot of type T (resolved once per type, no map lookup)
+	template<typename T>
+	slot_t& get_slot()
+	{
+		static slot_t& slot = add_slot(get_id_type_index<T>());
+
+		return slot;
+	}
 
 	// Remove all objects
 	void clear();
@@ -303,26 +354,24 @@ namespace fxm
 	template<typename T, bool Always, typename Ptr>
 	std::pair<std::shared_ptr<T>, std::shared_ptr<T>> add(Ptr&& get_ptr)
 	{
-		extern shared_mutex g_mutex;
-		extern fxm::map_t g_map;
+		extern std::mutex g_mutex;
 
-		std::lock_guard<shared_mutex> lock(g_mutex);
+		auto& slot = get_slot<T>();
 
-		auto& item = g_map[get_id_type_index<T>()];
+		std::lock_guard<std::mutex> lock(g_mutex);
 
-		if (Always || !item)
+		if (Always || !slot.data)
 		{
-			std::shared_ptr<T> old = std::static_pointer_cast<T>(std::move(item));
 			std::shared_ptr<T> ptr = get_ptr();
 
 			// Set new object
-			item = ptr;
+			std::shared_ptr<T> old = std::static_pointer_cast<T>(std::atomic_exchange(&slot.data, std::shared_ptr<void>(ptr)));
 
 			return{ std::move(old), std::move(ptr) };
 		}
 		else
 		{
-			return{ std::static_pointer_cast<T>(item), nullptr };
+			return{ std::static_pointer_cast<T>(slot.data), nullptr };
 		}
 	}
 
@@ -403,34 +452,28 @@ namespace fxm
 		return std::move(pair.first);
 	}
 
-	// Internal
-	bool check(id_type_index_t type);
-
 	// Check whether the object exists
 	template<typename T>
 	bool check()
 	{
-		return check(get_id_type_index<T>());
+		return std::atomic_load(&get_slot<T>().data) != nullptr;
 	}
 
-	// Internal
-	std::shared_ptr<void> get(id_type_index_t type);
-
 	// Get the object (returns nullptr if it doesn't exist)
 	template<typename T>
 	std::shared_ptr<T> get()
 	{
-		return std::static_pointer_cast<T>(get(get_id_type_index<T>()));
+		return std::static_pointer_cast<T>(std::atomic_load(&get_slot<T>().data));
 	}
 
 	// Internal
-	std::shared_ptr<void> withdraw(id_type_index_t type);
+	std::shared_ptr<void> withdraw(slot_t& slot);
 
 	// Delete the object
 	template<typename T>
 	bool remove()
 	{
-		if (auto ptr = withdraw(get_id_type_index<T>()))
+		if (auto ptr = withdraw(get_slot<T>()))
 		{
 			id_aux_finalize(static_cast<T*>(ptr.get()));
 			return true;
@@ -443,7 +486,7 @@ namespace fxm
 	template<typename T>
 	std::shared_ptr<T> withdraw()
 	{
-		if (auto ptr = std::static_pointer_cast<T>(withdraw(get_id_type_index<T>())))
+		if (auto ptr = std::static_pointer_cast<T>(withdraw(get_slot<T>())))
 		{
 			id_aux_finalize(ptr.get());
 			return ptr;
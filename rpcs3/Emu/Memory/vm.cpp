@@ -157,6 +157,12 @@ namespace vm
 
 	reservation_mutex_t g_reservation_mutex;
 
+	std::unordered_map<const void*, code_watcher_t> g_code_watchers;
+
+	std::mutex g_code_watchers_mutex;
+
+	void _code_notify(u32 addr, u32 size);
+
 	std::array<waiter_t, 1024> g_waiter_list;
 
 	std::size_t g_waiter_max = 0; // min unused position
@@ -385,11 +391,14 @@ namespace vm
 	{
 		if (g_reservation_addr >> 12 == addr >> 12)
 		{
+			// watched code pages stay write-protected
+			const bool code = (g_pages[addr >> 12] & page_code_watch) != 0;
+
 #ifdef _WIN32
 			DWORD old;
-			if (!::VirtualProtect(vm::base(addr & ~0xfff), 4096, PAGE_READWRITE, &old))
+			if (!::VirtualProtect(vm::base(addr & ~0xfff), 4096, code ? PAGE_READONLY : PAGE_READWRITE, &old))
 #else
-			if (::mprotect(vm::base(addr & ~0xfff), 4096, PROT_READ | PROT_WRITE))
+			if (::mprotect(vm::base(addr & ~0xfff), 4096, code ? PROT_READ : PROT_READ | PROT_WRITE))
 #endif
 			{
 				throw EXCEPTION("System failure (addr=0x%x)", addr);
@@ -477,12 +486,20 @@ namespace vm
 		// update memory using privileged access
 		std::memcpy(vm::base_priv(addr), data, size);
 
+		// privileged access bypasses code page protection
+		const bool code = (g_pages[addr >> 12]._and_not(page_code_watch) & page_code_watch) != 0;
+
 		// free the reservation and restore memory protection
 		_reservation_break(addr);
 
 		// notify waiter
 		lock.unlock(), _notify_at(addr, size);
 
+		if (code)
+		{
+			_code_notify(addr & ~0xfff, 4096);
+		}
+
 		// atomic update succeeded
 		return true;
 	}
@@ -577,11 +594,133 @@ namespace vm
 		// do the operation
 		proc();
 
+		// privileged access bypasses code page protection
+		const bool code = (g_pages[addr >> 12]._and_not(page_code_watch) & page_code_watch) != 0;
+
 		// remove the reservation
 		_reservation_break(addr);
 
 		// notify waiter
 		lock.unlock(), _notify_at(addr, size);
+
+		if (code)
+		{
+			_code_notify(addr & ~0xfff, 4096);
+		}
+	}
+
+	void _code_notify(u32 addr, u32 size)
+	{
+		std::lock_guard<std::mutex> lock(g_code_watchers_mutex);
+
+		for (auto& watcher : g_code_watchers)
+		{
+			watcher.second(addr, size);
+		}
+	}
+
+	void watch_code(u32 addr, u32 size)
+	{
+		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+
+		if (!size || (size | addr) % 4096)
+		{
+			throw EXCEPTION("Invalid arguments (addr=0x%x, size=0x%x)", addr, size);
+		}
+
+		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
+		{
+			const u8 flags = g_pages[i]._or(page_code_watch);
+
+			// skip unmapped, read-only and already watched pages, don't touch protection of the reserved page
+			if ((flags & (page_allocated | page_writable | page_code_watch)) != (page_allocated | page_writable) || g_reservation_addr >> 12 == i)
+			{
+				if (!(flags & page_allocated)) g_pages[i]._and_not(page_code_watch);
+				continue;
+			}
+
+#ifdef _WIN32
+			DWORD old;
+			if (!::VirtualProtect(vm::base(i * 4096), 4096, PAGE_READONLY, &old))
+#else
+			if (::mprotect(vm::base(i * 4096), 4096, PROT_READ))
+#endif
+			{
+				throw EXCEPTION("System failure (addr=0x%x, size=0x%x)", addr, size);
+			}
+		}
+	}
+
+	bool code_write_notify(u32 addr)
+	{
+		const u32 page = addr >> 12;
+
+		if (g_pages[page] & page_code_watch)
+		{
+			// invalidate translated code before the memory is actually modified (may be done by several faulting threads)
+			_code_notify(addr & ~0xfff, 4096);
+		}
+
+		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+
+		// the flag is only removed after the page is unprotected, so this check is stable under the lock
+		if (!(g_pages[page] & page_code_watch))
+		{
+			// page already unprotected by another thread: restart the instruction unless it's a different kind of fault
+			return (g_pages[page] & (page_allocated | page_writable)) == (page_allocated | page_writable) && g_reservation_addr >> 12 != page;
+		}
+
+		// the reserved page keeps its protection, the access will be processed by reservation_query()
+		if (g_reservation_addr >> 12 != page && g_pages[page] & page_writable)
+		{
+#ifdef _WIN32
+			DWORD old;
+			if (!::VirtualProtect(vm::base(addr & ~0xfff), 4096, PAGE_READWRITE, &old))
+#else
+			if (::mprotect(vm::base(addr & ~0xfff), 4096, PROT_READ | PROT_WRITE))
+#endif
+			{
+				throw EXCEPTION("System failure (addr=0x%x)", addr);
+			}
+		}
+
+		g_pages[page]._and_not(page_code_watch);
+
+		return true;
+	}
+
+	void host_write_notify(const void* ptr, u64 size)
+	{
+		const std::ptrdiff_t diff = static_cast<const u8*>(ptr) - g_base_addr;
+
+		if (!size || diff < 0 || diff >= 0x100000000ll)
+		{
+			return;
+		}
+
+		const u64 end = std::min<u64>(diff + size, 0x100000000ull);
+
+		for (u64 page = diff / 4096; page < (end + 4095) / 4096; page++)
+		{
+			if (g_pages[page] & page_code_watch)
+			{
+				code_write_notify(static_cast<u32>(page * 4096));
+			}
+		}
+	}
+
+	void add_code_watcher(const void* owner, code_watcher_t handler)
+	{
+		std::lock_guard<std::mutex> lock(g_code_watchers_mutex);
+
+		g_code_watchers[owner] = std::move(handler);
+	}
+
+	void remove_code_watcher(const void* owner)
+	{
+		std::lock_guard<std::mutex> lock(g_code_watchers_mutex);
+
+		g_code_watchers.erase(owner);
 	}
 
 	void _page_map(u32 addr, u32 size, u8 flags)
@@ -656,12 +795,18 @@ namespace vm
 
 			const u8 f1 = g_pages[i]._or(flags_set & ~flags_inv) & (page_writable | page_readable);
 			g_pages[i]._and_not(flags_clear & ~flags_inv);
-			const u8 f2 = (g_pages[i] ^= flags_inv) & (page_writable | page_readable);
+			u8 f2 = (g_pages[i] ^= flags_inv) & (page_writable | page_readable);
 
 			if (f1 != f2)
 			{
 				void* real_addr = vm::base(i * 4096);
 
+				// keep watched code pages write-protected
+				if (g_pages[i] & page_code_watch)
+				{
+					f2 &= ~page_writable;
+				}
+
 #ifdef _WIN32
 				DWORD old;
 
@@ -695,14 +840,26 @@ namespace vm
 			}
 		}
 
+		bool code = false;
+
 		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
 		{
 			_reservation_break(i * 4096);
 
-			if (!(g_pages[i].exchange(0) & page_allocated))
+			const u8 flags = g_pages[i].exchange(0);
+
+			if (!(flags & page_allocated))
 			{
 				throw EXCEPTION("Concurrent access (addr=0x%x, size=0x%x, current_addr=0x%x)", addr, size, i * 4096);
 			}
+
+			code |= (flags & page_code_watch) != 0;
+		}
+
+		if (code)
+		{
+			// translated code in the unmapped area is no longer valid
+			_code_notify(addr, size);
 		}
 
 		void* real_addr = vm::base(addr);
@@ -26,6 +26,7 @@ namespace vm
 
 		page_fault_notification = (1 << 3),
 		page_no_reservations    = (1 << 4),
+		page_code_watch         = (1 << 5),
 
 		page_allocated          = (1 << 7),
 	};
@@ -130,6 +131,23 @@ namespace vm
 	// Change memory protection of specified memory region
 	bool page_protect(u32 addr, u32 size, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
 
+	// Write-protect pages containing decoded or compiled code, code watchers are notified on the first write or unmapping
+	void watch_code(u32 addr, u32 size);
+
+	// Process a write access to a watched code page, unprotect it and notify code watchers (returns false if not watched)
+	bool code_write_notify(u32 addr);
+
+	// Unprotect watched code pages before the host writes to guest memory directly (host I/O fails instead of faulting), ignores other pointers
+	void host_write_notify(const void* ptr, u64 size);
+
+	using code_watcher_t = std::function<void(u32 addr, u32 size)>;
+
+	// Register a function which invalidates translated code in the modified area (identified by owner)
+	void add_code_watcher(const void* owner, code_watcher_t handler);
+
+	// Unregister a code watcher
+	void remove_code_watcher(const void* owner);
+
 	// Check if existing memory range is allocated. Checking address before using it is very unsafe.
 	// Return value may be wrong. Even if it's true and correct, actual memory protection may be read-only and no-access.
 	bool check_addr(u32 addr, u32 size = 1);
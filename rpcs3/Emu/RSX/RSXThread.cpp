@@ -2,6 +2,7 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/state.h"
+#include "Emu/TimerService.h"
 #include "Emu/RSX/GSManager.h"
 #include "RSXThread.h"
 
@@ -313,33 +314,25 @@ namespace rsx
 
 		last_flip_time = get_system_time() - 1000000;
 
-		scope_thread_t vblank(PURE_EXPR("VBlank Thread"s), [this]()
-		{
-			const u64 start_time = get_system_time();
+		const u64 vblank_start = get_system_time();
+
+		vblank_count = 0;
 
-			vblank_count = 0;
+		scope_timer_t vblank(vblank_start, [this, vblank_start](u64 now) -> u64
+		{
+			vblank_count++;
 
-			// TODO: exit condition
-			while (!Emu.IsStopped())
+			if (vblank_handler)
 			{
-				if (get_system_time() - start_time > vblank_count * 1000000 / 60)
+				Emu.GetCallbackManager().Async([func = vblank_handler](PPUThread& ppu)
 				{
-					vblank_count++;
-
-					if (vblank_handler)
-					{
-						Emu.GetCallbackManager().Async([func = vblank_handler](PPUThread& ppu)
-						{
-							func(ppu, 1);
-						});
-					}
-
-					continue;
-				}
-
-				std::this_thread::sleep_for(1ms); // hack
+					func(ppu, 1);
+				});
 			}
-		});
+
+			// 60 Hz (called again immediately if late)
+			return vblank_start + vblank_count * 1000000 / 60 + 1;
+		}, true);
 
 		// TODO: exit condition
 		while (true)
@@ -12,25 +12,33 @@ std::vector<ModuleFunc> g_ppu_func_list;
 std::vector<StaticFunc> g_ppu_func_subs;
 std::vector<ModuleVariable> g_ps3_var_list;
 
+// NID -> index in g_ppu_func_list
+std::unordered_map<u32, u32> g_ppu_func_index;
+
+// NID -> index in g_ps3_var_list
+std::unordered_map<u32, u32> g_ps3_var_index;
+
 u32 add_ppu_func(ModuleFunc func)
 {
 	if (g_ppu_func_list.empty())
 	{
 		// prevent relocations if the array growths, must be sizeof(ModuleFunc) * 0x8000 ~~ about 1 MB of memory
 		g_ppu_func_list.reserve(0x8000);
+		g_ppu_func_index.reserve(0x8000);
 	}
 
-	for (auto& f : g_ppu_func_list)
+	const auto result = g_ppu_func_index.emplace(func.id, size32(g_ppu_func_list));
+
+	if (!result.second)
 	{
-		if (f.id == func.id)
-		{
-			// if NIDs overlap or if the same function is added twice
-			throw EXCEPTION("FNID already exists: 0x%08x (%s)", f.id, f.name);
-		}
+		// if NIDs overlap or if the same function is added twice
+		const auto& f = g_ppu_func_list[result.first->second];
+
+		throw EXCEPTION("FNID already exists: 0x%08x (%s)", f.id, f.name);
 	}
 
 	g_ppu_func_list.emplace_back(std::move(func));
-	return (u32)g_ppu_func_list.size() - 1;
+	return result.first->second;
 }
 
 void add_variable(u32 nid, Module<>* module, const char* name, u32(*addr)())
@@ -38,14 +46,12 @@ void add_variable(u32 nid, Module<>* module, const char* name, u32(*addr)())
 	if (g_ps3_var_list.empty())
 	{
 		g_ps3_var_list.reserve(0x4000); // as g_ppu_func_list
+		g_ps3_var_index.reserve(0x4000);
 	}
 
-	for (auto& v : g_ps3_var_list)
+	if (!g_ps3_var_index.emplace(nid, size32(g_ps3_var_list)).second)
 	{
-		if (v.id == nid)
-		{
-			throw EXCEPTION("VNID already exists: 0x%08x (%s)", nid, name);
-		}
+		throw EXCEPTION("VNID already exists: 0x%08x (%s)", nid, name);
 	}
 
 	g_ps3_var_list.emplace_back(ModuleVariable{ nid, module, name, addr });
@@ -53,15 +59,14 @@ void add_variable(u32 nid, Module<>* module, const char* name, u32(*addr)())
 
 ModuleVariable* get_variable_by_nid(u32 nid)
 {
-	for (auto& v : g_ps3_var_list)
+	const auto found = g_ps3_var_index.find(nid);
+
+	if (found == g_ps3_var_index.end())
 	{
-		if (v.id == nid)
-		{
-			return &v;
-		}
+		return nullptr;
 	}
 
-	return nullptr;
+	return &g_ps3_var_list[found->second];
 }
 
 u32 add_ppu_func_sub(StaticFunc func)
@@ -83,20 +88,19 @@ u32 add_ppu_func_sub(const std::initializer_list<SearchPatternEntry>& ops, const
 
 ModuleFunc* get_ppu_func_by_nid(u32 nid, u32* out_index)
 {
-	for (auto& f : g_ppu_func_list)
+	const auto found = g_ppu_func_index.find(nid);
+
+	if (found == g_ppu_func_index.end())
 	{
-		if (f.id == nid)
-		{
-			if (out_index)
-			{
-				*out_index = (u32)(&f - g_ppu_func_list.data());
-			}
+		return nullptr;
+	}
 
-			return &f;
-		}
+	if (out_index)
+	{
+		*out_index = found->second;
 	}
 
-	return nullptr;
+	return &g_ppu_func_list[found->second];
 }
 
 ModuleFunc* get_ppu_func_by_index(u32 index)
@@ -215,6 +219,8 @@ void clear_ppu_functions()
 	g_ppu_func_list.clear();
 	g_ppu_func_subs.clear();
 	g_ps3_var_list.clear();
+	g_ppu_func_index.clear();
+	g_ps3_var_index.clear();
 }
 
 u32 get_function_id(const char* name)
@@ -233,148 +239,237 @@ u32 get_function_id(const char* name)
 	return (u32&)output[0];
 }
 
-void hook_ppu_func(vm::ptr<u32> base, u32 pos, u32 size)
+// Check whether the pattern matches the code at specified position (code[pos] must not be NOP)
+static bool match_ppu_func(const StaticFunc& sub, const be_t<u32>* code, u32 base_addr, u32 pos, u32 size)
 {
-	using namespace PPU_instr;
+	std::unordered_map<u32, u32> labels;
 
-	for (auto& sub : g_ppu_func_subs)
+	for (u32 k = pos, x = 0; x + 1 <= sub.ops.size(); k++, x++)
 	{
-		bool found = sub.ops.size() != 0;
+		if (k >= size)
+		{
+			return false;
+		}
 
-		for (u32 k = pos, x = 0; x + 1 <= sub.ops.size(); k++, x++)
+		// skip NOP
+		if (code[k] == 0x60000000)
+		{
+			x--;
+			continue;
+		}
+
+		const be_t<u32> data = sub.ops[x].data;
+		const be_t<u32> mask = sub.ops[x].mask;
+
+		const bool match = (code[k] & mask) == data;
+
+		switch (sub.ops[x].type)
+		{
+		case SPET_MASKED_OPCODE:
 		{
-			if (k >= size)
+			// masked pattern
+			if (!match)
 			{
-				found = false;
-				break;
+				return false;
 			}
 
-			// skip NOP
-			if (base[k] == 0x60000000)
+			break;
+		}
+		case SPET_OPTIONAL_MASKED_OPCODE:
+		{
+			// optional masked pattern
+			if (!match)
 			{
-				x--;
-				continue;
+				k--;
 			}
 
-			const be_t<u32> data = sub.ops[x].data;
-			const be_t<u32> mask = sub.ops[x].mask;
-
-			const bool match = (base[k] & mask) == data;
+			break;
+		}
+		case SPET_LABEL:
+		{
+			const u32 addr = base_addr + k-- * 4;
+			const u32 lnum = data;
+			const auto label = labels.find(lnum);
 
-			switch (sub.ops[x].type)
-			{
-			case SPET_MASKED_OPCODE:
+			if (label == labels.end()) // register the label
 			{
-				// masked pattern
-				if (!match)
-				{
-					found = false;
-				}
-
-				break;
+				labels[lnum] = addr;
 			}
-			case SPET_OPTIONAL_MASKED_OPCODE:
+			else if (label->second != addr) // or check registered label
 			{
-				// optional masked pattern
-				if (!match)
-				{
-					k--;
-				}
-
-				break;
+				return false;
 			}
-			case SPET_LABEL:
-			{
-				const u32 addr = (base + k--).addr();
-				const u32 lnum = data;
-				const auto label = sub.labels.find(lnum);
-
-				if (label == sub.labels.end()) // register the label
-				{
-					sub.labels[lnum] = addr;
-				}
-				else if (label->second != addr) // or check registered label
-				{
-					found = false;
-				}
 
-				break;
-			}
-			case SPET_BRANCH_TO_LABEL:
+			break;
+		}
+		case SPET_BRANCH_TO_LABEL:
+		{
+			if (!match)
 			{
-				if (!match)
-				{
-					found = false;
-					break;
-				}
+				return false;
+			}
 
-				const auto addr = (base[k] & 2 ? 0 : (base + k).addr()) + ((s32)base[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
-				const auto lnum = sub.ops[x].num;
-				const auto label = sub.labels.find(lnum);
+			const auto addr = (code[k] & 2 ? 0 : base_addr + k * 4) + ((s32)code[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
+			const auto lnum = sub.ops[x].num;
+			const auto label = labels.find(lnum);
 
-				if (label == sub.labels.end()) // register the label
-				{
-					sub.labels[lnum] = addr;
-				}
-				else if (label->second != addr) // or check registered label
-				{
-					found = false;
-				}
-
-				break;
-			}
-			//case SPET_BRANCH_TO_FUNC:
-			//{
-			//	if (!match)
-			//	{
-			//		found = false;
-			//		break;
-			//	}
-
-			//	const auto addr = (base[k] & 2 ? 0 : (base + k).addr()) + ((s32)base[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
-			//	const auto nid = sub.ops[x].num;
-			//	// TODO: recursive call
-			//}
-			default:
+			if (label == labels.end()) // register the label
 			{
-				throw EXCEPTION("Unknown search pattern type (%d)", sub.ops[x].type);
+				labels[lnum] = addr;
 			}
-			}
-
-			if (!found)
+			else if (label->second != addr) // or check registered label
 			{
-				break;
+				return false;
 			}
-		}
 
-		if (found)
-		{
-			LOG_SUCCESS(LOADER, "Function '%s' hooked (addr=*0x%x)", sub.name, base + pos);
-			sub.found++;
-			base[pos] = HACK(sub.index | EIF_PERFORM_BLR);
+			break;
 		}
-
-		if (sub.labels.size())
+		//case SPET_BRANCH_TO_FUNC:
+		//{
+		//	if (!match)
+		//	{
+		//		return false;
+		//	}
+
+		//	const auto addr = (code[k] & 2 ? 0 : base_addr + k * 4) + ((s32)code[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
+		//	const auto nid = sub.ops[x].num;
+		//	// TODO: recursive call
+		//}
+		default:
 		{
-			sub.labels.clear();
+			throw EXCEPTION("Unknown search pattern type (%d)", sub.ops[x].type);
+		}
 		}
 	}
+
+	return sub.ops.size() != 0;
 }
 
 void hook_ppu_funcs(vm::ptr<u32> base, u32 size)
 {
 	using namespace PPU_instr;
 
-	// TODO: optimize search
-	for (u32 i = 0; i < size; i++)
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const be_t<u32>* const code = base.get_ptr();
+
+	// Index patterns by their first opcode: (mask, masked opcode -> patterns)
+	std::vector<std::pair<u32, std::unordered_map<u32, std::vector<u32>>>> index;
+
+	// Patterns starting with an optional opcode or a label are tested at every position
+	std::vector<u32> unindexed;
+
+	for (u32 i = 0; i < g_ppu_func_subs.size(); i++)
 	{
-		// skip NOP
-		if (base[i] == 0x60000000)
+		const auto& ops = g_ppu_func_subs[i].ops;
+
+		if (ops.empty())
+		{
+			continue;
+		}
+
+		if (ops[0].type != SPET_MASKED_OPCODE && ops[0].type != SPET_BRANCH_TO_LABEL)
 		{
+			unindexed.push_back(i);
 			continue;
 		}
 
-		hook_ppu_func(base, i, size);
+		const u32 mask = ops[0].mask;
+
+		auto found = std::find_if(index.begin(), index.end(), [=](const auto& e) { return e.first == mask; });
+
+		if (found == index.end())
+		{
+			found = index.emplace(index.end(), mask, std::unordered_map<u32, std::vector<u32>>{});
+		}
+
+		found->second[ops[0].data].push_back(i);
+	}
+
+	// Matches found by each worker (position, pattern index)
+	const u32 chunk_size = 0x4000;
+	const u32 chunk_count = (size + chunk_size - 1) / chunk_size;
+	const u32 thread_count = std::max<u32>(std::min<u32>(std::thread::hardware_concurrency(), chunk_count), 1);
+
+	std::vector<std::vector<std::pair<u32, u32>>> results(thread_count);
+	std::atomic<u32> next_chunk{ 0 };
+
+	auto worker = [&](u32 id)
+	{
+		for (u32 chunk; (chunk = next_chunk++) < chunk_count;)
+		{
+			for (u32 i = chunk * chunk_size; i < std::min(size, (chunk + 1) * chunk_size); i++)
+			{
+				const u32 op = code[i];
+
+				// skip NOP
+				if (op == 0x60000000)
+				{
+					continue;
+				}
+
+				for (auto& e : index)
+				{
+					const auto found = e.second.find(op & e.first);
+
+					if (found == e.second.end())
+					{
+						continue;
+					}
+
+					for (u32 sub : found->second)
+					{
+						if (match_ppu_func(g_ppu_func_subs[sub], code, base.addr(), i, size))
+						{
+							results[id].emplace_back(i, sub);
+						}
+					}
+				}
+
+				for (u32 sub : unindexed)
+				{
+					if (match_ppu_func(g_ppu_func_subs[sub], code, base.addr(), i, size))
+					{
+						results[id].emplace_back(i, sub);
+					}
+				}
+			}
+		}
+	};
+
+	{
+		std::vector<std::unique_ptr<scope_thread_t>> threads;
+
+		for (u32 i = 1; i < thread_count; i++)
+		{
+			threads.emplace_back(std::make_unique<scope_thread_t>([i]() { return fmt::format("Hook Search Thread %u", i); }, [&worker, i]() { worker(i); }));
+		}
+
+		worker(0);
+	}
+
+	// Patch the code after the search, only the first registered pattern is used at every position
+	std::vector<std::pair<u32, u32>> matches;
+
+	for (auto& r : results)
+	{
+		matches.insert(matches.end(), r.begin(), r.end());
+	}
+
+	std::sort(matches.begin(), matches.end());
+
+	matches.erase(std::unique(matches.begin(), matches.end(), [](const std::pair<u32, u32>& a, const std::pair<u32, u32>& b)
+	{
+		return a.first == b.first;
+	}), matches.end());
+
+	for (auto& m : matches)
+	{
+		auto& sub = g_ppu_func_subs[m.second];
+
+		LOG_SUCCESS(LOADER, "Function '%s' hooked (addr=*0x%x)", sub.name, base + m.first);
+		sub.found++;
+		base[m.first] = HACK(sub.index | EIF_PERFORM_BLR);
 	}
 
 	// check functions
@@ -382,9 +477,13 @@ void hook_ppu_funcs(vm::ptr<u32> base, u32 size)
 	{
 		if (g_ppu_func_subs[i].found > 1)
 		{
-			LOG_ERROR(LOADER, "Function '%s' hooked %u times", g_ppu_func_subs[i].found);
+			LOG_ERROR(LOADER, "Function '%s' hooked %u times", g_ppu_func_subs[i].name, g_ppu_func_subs[i].found);
 		}
 	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+	LOG_NOTICE(LOADER, "Static function search: 0x%x bytes, %u patterns, %u threads, %lld ms", size * 4, size32(g_ppu_func_subs), thread_count, elapsed.count());
 }
 
 bool patch_ppu_import(u32 addr, u32 index)
@@ -9,6 +9,7 @@
 #include "Emu/SysCalls/lv2/sys_sync.h"
 #include "Emu/SysCalls/lv2/sys_event.h"
 #include "Emu/Event.h"
+#include "Emu/TimerService.h"
 #include "Emu/Audio/AudioManager.h"
 #include "Emu/Audio/AudioDumper.h"
 
@@ -131,6 +132,12 @@ s32 cellAudioInit()
 			Emu.GetAudioManager().GetAudioOut().Quit();
 		});
 
+		const auto timers = fxm::get_always<timer_service_t>();
+
+		// used to wait for the next period
+		std::mutex period_mutex;
+		std::condition_variable period_cv;
+
 		while (g_audio.state == AUDIO_STATE_INITIALIZED && !Emu.IsStopped())
 		{
 			if (Emu.IsPaused())
@@ -149,7 +156,9 @@ s32 cellAudioInit()
 			const u64 expected_time = g_audio.counter * AUDIO_SAMPLES * 1000000 / 48000;
 			if (expected_time >= time_pos)
 			{
-				std::this_thread::sleep_for(1ms); // hack
+				std::unique_lock<std::mutex> lock(period_mutex);
+
+				timers->wait_until(stamp0 + expected_time - time_pos + 1, lock, period_cv);
 				continue;
 			}
 			
@@ -360,17 +369,25 @@ s32 cellAudioInit()
 
 				// send aftermix event (normal audio event)
 
-				LV2_LOCK;
-
-				std::lock_guard<std::mutex> lock(g_audio.mutex);
+				std::vector<std::shared_ptr<lv2_event_queue_t>> queues;
 
-				for (auto key : g_audio.keys)
 				{
-					if (const auto queue = Emu.GetEventManager().GetEventQueue(key))
+					std::lock_guard<std::mutex> lock(g_audio.mutex);
+
+					for (auto key : g_audio.keys)
 					{
-						queue->push(lv2_lock, 0, 0, 0, 0); // TODO: check arguments
+						if (const auto queue = Emu.GetEventManager().GetEventQueue(key))
+						{
+							queues.emplace_back(queue);
+						}
 					}
 				}
+
+				// the queue lock is acquired by push() only if a thread is waiting for the event
+				for (auto& queue : queues)
+				{
+					queue->push(0, 0, 0, 0); // TODO: check arguments
+				}
 			}
 			
 
@@ -15,7 +15,14 @@ s32 sys_lwcond_create(vm::ptr<sys_lwcond_t> lwcond, vm::ptr<sys_lwmutex_t> lwmut
 {
 	sysPrxForUser.warning("sys_lwcond_create(lwcond=*0x%x, lwmutex=*0x%x, attr=*0x%x)", lwcond, lwmutex, attr);
 
-	lwcond->lwcond_queue = idm::make<lv2_lwcond_t>(reinterpret_cast<u64&>(attr->name));
+	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex->sleep_queue);
+
+	if (!mutex)
+	{
+		return CELL_ESRCH;
+	}
+
+	lwcond->lwcond_queue = idm::make<lv2_lwcond_t>(mutex, reinterpret_cast<u64&>(attr->name));
 	lwcond->lwmutex = lwmutex;
 
 	return CELL_OK;
@@ -313,6 +313,8 @@ namespace sys_net
 		libnet.warning("recv(s=%d, buf=*0x%x, len=%d, flags=0x%x)", s, buf, len, flags);
 		s = g_socketMap[s];
 
+		vm::host_write_notify(buf.get_ptr(), len);
+
 		s32 ret = ::recv(s, buf.get_ptr(), len, flags);
 		get_errno() = getLastError();
 
@@ -328,6 +330,7 @@ namespace sys_net
 		memcpy(&_addr, addr.get_ptr(), sizeof(::sockaddr));
 		_addr.sa_family = addr->sa_family;
 		::socklen_t _paddrlen;
+		vm::host_write_notify(buf.get_ptr(), len);
 		s32 ret = ::recvfrom(s, buf.get_ptr(), len, flags, &_addr, &_paddrlen);
 		*paddrlen = _paddrlen;
 		get_errno() = getLastError();
@@ -5,8 +5,6 @@
 
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/SysCalls/lv2/sys_spu.h"
-#include "Emu/FS/vfsFile.h"
-#include "Crypto/unself.h"
 #include "sysPrxForUser.h"
 
 extern Module<> sysPrxForUser;
@@ -49,28 +47,13 @@ s32 sys_raw_spu_load(s32 id, vm::cptr<char> path, vm::ptr<u32> entry)
 	sysPrxForUser.warning("sys_raw_spu_load(id=%d, path=*0x%x, entry=*0x%x)", id, path, entry);
 	sysPrxForUser.warning("*** path = '%s'", path.get_ptr());
 
-	vfsFile f(path.get_ptr());
-	if (!f.IsOpened())
-	{
-		sysPrxForUser.error("sys_raw_spu_load error: '%s' not found!", path.get_ptr());
-		return CELL_ENOENT;
-	}
-
-	SceHeader hdr;
-	hdr.Load(f);
+	u32 _entry;
 
-	if (hdr.CheckMagic())
+	if (const s32 res = LoadSpuImage(path.get_ptr(), _entry, RAW_SPU_BASE_ADDR + RAW_SPU_OFFSET * id))
 	{
-		sysPrxForUser.error("sys_raw_spu_load error: '%s' is encrypted! Decrypt SELF and try again.", path.get_ptr());
-		Emu.Pause();
-		return CELL_ENOENT;
+		return res;
 	}
 
-	f.Seek(0);
-
-	u32 _entry;
-	LoadSpuImage(f, _entry, RAW_SPU_BASE_ADDR + RAW_SPU_OFFSET * id);
-
 	*entry = _entry | 1;
 
 	return CELL_OK;
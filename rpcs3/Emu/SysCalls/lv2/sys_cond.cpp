@@ -12,19 +12,20 @@
 SysCallBase sys_cond("sys_cond");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
-void lv2_cond_t::notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread)
+void lv2_cond_t::notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type thread)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
 	if (mutex->owner)
 	{
 		// add thread to the mutex sleep queue if cannot lock immediately
-		mutex->sq.emplace_back(thread);
+		mutex->sq.push(*thread);
 	}
 	else
 	{
-		mutex->owner = thread;
+		mutex->owner = std::static_pointer_cast<CPUThread>(thread->shared_from_this());
 
 		if (!thread->signal())
 		{
@@ -37,9 +38,9 @@ s32 sys_cond_create(vm::ptr<u32> cond_id, u32 mutex_id, vm::ptr<sys_cond_attribu
 {
 	sys_cond.warning("sys_cond_create(cond_id=*0x%x, mutex_id=0x%x, attr=*0x%x)", cond_id, mutex_id, attr);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_mutex_t>(mutex_id);
+	const auto mutex = lv2_lock_object<lv2_mutex_t>(mutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -66,9 +67,9 @@ s32 sys_cond_destroy(u32 cond_id)
 {
 	sys_cond.warning("sys_cond_destroy(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_cond_t>(cond_id);
+	const auto cond = lv2_lock_object<lv2_cond_t>(cond_id, lv2_lock);
 
 	if (!cond)
 	{
@@ -94,20 +95,21 @@ s32 sys_cond_signal(u32 cond_id)
 {
 	sys_cond.trace("sys_cond_signal(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_cond_t>(cond_id);
+	const auto cond = lv2_lock_object<lv2_cond_t>(cond_id, lv2_lock);
 
 	if (!cond)
 	{
 		return CELL_ESRCH;
 	}
 
-	// signal one waiting thread; protocol is ignored in current implementation
+	// signal one waiting thread (removed first, it may be added to the mutex sleep queue)
 	if (!cond->sq.empty())
 	{
-		cond->notify(lv2_lock, cond->sq.front());
+		const auto thread = cond->sq.front();
 		cond->sq.pop_front();
+		cond->notify(lv2_lock, thread);
 	}
 
 	return CELL_OK;
@@ -117,23 +119,23 @@ s32 sys_cond_signal_all(u32 cond_id)
 {
 	sys_cond.trace("sys_cond_signal_all(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_cond_t>(cond_id);
+	const auto cond = lv2_lock_object<lv2_cond_t>(cond_id, lv2_lock);
 
 	if (!cond)
 	{
 		return CELL_ESRCH;
 	}
 
-	// signal all waiting threads; protocol is ignored in current implementation
-	for (auto& thread : cond->sq)
+	// signal all waiting threads
+	while (!cond->sq.empty())
 	{
+		const auto thread = cond->sq.front();
+		cond->sq.pop_front();
 		cond->notify(lv2_lock, thread);
 	}
 
-	cond->sq.clear();
-
 	return CELL_OK;
 }
 
@@ -141,16 +143,16 @@ s32 sys_cond_signal_to(u32 cond_id, u32 thread_id)
 {
 	sys_cond.trace("sys_cond_signal_to(cond_id=0x%x, thread_id=0x%x)", cond_id, thread_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_cond_t>(cond_id);
+	const auto cond = lv2_lock_object<lv2_cond_t>(cond_id, lv2_lock);
 
 	if (!cond)
 	{
 		return CELL_ESRCH;
 	}
 
-	const auto found = std::find_if(cond->sq.begin(), cond->sq.end(), [=](sleep_queue_t::value_type& thread)
+	const auto found = std::find_if(cond->sq.begin(), cond->sq.end(), [=](sleep_queue_t::value_type thread)
 	{
 		return thread->get_id() == thread_id;
 	});
@@ -162,8 +164,9 @@ s32 sys_cond_signal_to(u32 cond_id, u32 thread_id)
 	}
 
 	// signal specified thread
-	cond->notify(lv2_lock, *found);
+	const auto thread = *found;
 	cond->sq.erase(found);
+	cond->notify(lv2_lock, thread);
 
 	return CELL_OK;
 }
@@ -174,9 +177,9 @@ s32 sys_cond_wait(PPUThread& ppu, u32 cond_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_cond_t>(cond_id);
+	const auto cond = lv2_lock_object<lv2_cond_t>(cond_id, lv2_lock);
 
 	if (!cond)
 	{
@@ -195,7 +198,7 @@ s32 sys_cond_wait(PPUThread& ppu, u32 cond_id, u64 timeout)
 	// unlock the mutex
 	cond->mutex->unlock(lv2_lock);
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, cond->sq);
 
 	// potential mutex waiter (not added immediately)
@@ -220,12 +223,12 @@ s32 sys_cond_wait(PPUThread& ppu, u32 cond_id, u64 timeout)
 				}
 
 				// drop condition variable and start waiting on the mutex queue
-				mutex_waiter.enter();
 				waiter.leave();
+				mutex_waiter.enter();
 				continue;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -1,11 +1,10 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_mutex.h"
 
 namespace vm { using namespace ps3; }
 
-struct lv2_mutex_t;
-
 struct sys_cond_attribute_t
 {
 	be_t<u32> pshared;
@@ -26,13 +25,17 @@ struct lv2_cond_t
 
 	sleep_queue_t sq;
 
+	std::mutex& lock; // lock of the associated mutex
+
 	lv2_cond_t(const std::shared_ptr<lv2_mutex_t>& mutex, u64 name)
 		: mutex(mutex)
 		, name(name)
+		, sq(lv2_sync_priority(mutex->protocol))
+		, lock(mutex->lock)
 	{
 	}
 
-	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread);
+	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type thread);
 };
 
 class PPUThread;
@@ -7,6 +7,7 @@
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Event.h"
+#include "Emu/TimerService.h"
 #include "sys_sync.h"
 #include "sys_process.h"
 #include "sys_event.h"
@@ -15,6 +16,19 @@ SysCallBase sys_event("sys_event");
 
 extern u64 get_system_time();
 
+// Get the smallest power of 2 not less than size
+static u32 get_ring_capacity(s32 size)
+{
+	u32 result = 1;
+
+	while (result < static_cast<u32>(size))
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
 lv2_event_queue_t::lv2_event_queue_t(u32 protocol, s32 type, u64 name, u64 key, s32 size)
 	: id(idm::get_last_id())
 	, protocol(protocol)
@@ -22,55 +36,114 @@ lv2_event_queue_t::lv2_event_queue_t(u32 protocol, s32 type, u64 name, u64 key,
 	, name(name)
 	, key(key)
 	, size(size)
+	, m_mask(get_ring_capacity(size) - 1)
+	, m_cells(std::make_unique<event_cell_t[]>(m_mask + 1))
+	, sq(lv2_sync_priority(protocol))
 {
 }
 
-void lv2_event_queue_t::push(lv2_lock_t& lv2_lock, u64 source, u64 data1, u64 data2, u64 data3)
+bool lv2_event_queue_t::push(u64 source, u64 data1, u64 data2, u64 data3)
 {
-	CHECK_LV2_LOCK(lv2_lock);
-
-	// save event if no waiters
-	if (sq.empty())
+	// reserve space
+	for (s32 count = m_count; true; /**/)
 	{
-		return events.emplace_back(source, data1, data2, data3);
-	}
+		if (count >= size)
+		{
+			return false;
+		}
 
-	if (events.size())
-	{
-		throw EXCEPTION("Unexpected");
+		if (m_count.compare_exchange_weak(count, count + 1))
+		{
+			break;
+		}
 	}
 
-	// notify waiter; protocol is ignored in current implementation
-	auto& thread = sq.front();
+	// the cell is free: it could only be occupied if more than size events were reserved
+	const u64 pos = m_push_pos++;
 
-	if (type == SYS_PPU_QUEUE && thread->get_type() == CPU_THREAD_PPU)
-	{
-		// store event data in registers
-		auto& ppu = static_cast<PPUThread&>(*thread);
+	auto& cell = m_cells[pos & m_mask];
 
-		ppu.GPR[4] = source;
-		ppu.GPR[5] = data1;
-		ppu.GPR[6] = data2;
-		ppu.GPR[7] = data3;
-	}
-	else if (type == SYS_SPU_QUEUE && thread->get_type() == CPU_THREAD_SPU)
+	cell.data = std::make_tuple(source, data1, data2, data3);
+	cell.seq = pos + 1;
+
+	// receivers are registered before checking for events, so the event can't be missed
+	if (m_receivers)
 	{
-		// store event data in In_MBox
-		auto& spu = static_cast<SPUThread&>(*thread);
+		lv2_lock_t lv2_lock(lock);
 
-		spu.ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(data1), static_cast<u32>(data2), static_cast<u32>(data3));
+		notify(lv2_lock);
 	}
-	else
+
+	return true;
+}
+
+bool lv2_event_queue_t::pop(lv2_lock_t& lv2_lock, event_type& event)
+{
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
+
+	auto& cell = m_cells[m_pop_pos & m_mask];
+
+	// check whether the event is written (push() may be still in progress)
+	if (cell.seq != m_pop_pos + 1)
 	{
-		throw EXCEPTION("Unexpected (queue_type=%d, thread_type=%d)", type, thread->get_type());
+		return false;
 	}
 
-	if (!sq.front()->signal())
+	event = cell.data;
+
+	m_pop_pos++;
+
+	// release the cell
+	m_count--;
+
+	return true;
+}
+
+void lv2_event_queue_t::clear(lv2_lock_t& lv2_lock)
+{
+	event_type event;
+
+	while (pop(lv2_lock, event))
 	{
-		throw EXCEPTION("Thread already signaled");
 	}
+}
+
+void lv2_event_queue_t::notify(lv2_lock_t& lv2_lock)
+{
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
+
+	event_type event;
+
+	while (!sq.empty() && pop(lv2_lock, event))
+	{
+		const auto thread = sq.front();
+
+		if (type == SYS_PPU_QUEUE && thread->get_type() == CPU_THREAD_PPU)
+		{
+			// store event data in registers
+			auto& ppu = static_cast<PPUThread&>(*thread);
 
-	return sq.pop_front();
+			std::tie(ppu.GPR[4], ppu.GPR[5], ppu.GPR[6], ppu.GPR[7]) = event;
+		}
+		else if (type == SYS_SPU_QUEUE && thread->get_type() == CPU_THREAD_SPU)
+		{
+			// store event data in In_MBox
+			auto& spu = static_cast<SPUThread&>(*thread);
+
+			spu.ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(std::get<1>(event)), static_cast<u32>(std::get<2>(event)), static_cast<u32>(std::get<3>(event)));
+		}
+		else
+		{
+			throw EXCEPTION("Unexpected (queue_type=%d, thread_type=%d)", type, thread->get_type());
+		}
+
+		if (!thread->signal())
+		{
+			throw EXCEPTION("Thread already signaled");
+		}
+
+		sq.pop_front();
+	}
 }
 
 s32 sys_event_queue_create(vm::ptr<u32> equeue_id, vm::ptr<sys_event_queue_attribute_t> attr, u64 event_queue_key, s32 size)
@@ -114,9 +187,9 @@ s32 sys_event_queue_destroy(u32 equeue_id, s32 mode)
 {
 	sys_event.warning("sys_event_queue_destroy(equeue_id=0x%x, mode=%d)", equeue_id, mode);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto queue = idm::get<lv2_event_queue_t>(equeue_id);
+	const auto queue = lv2_lock_object<lv2_event_queue_t>(equeue_id, lv2_lock);
 
 	if (!queue)
 	{
@@ -163,9 +236,9 @@ s32 sys_event_queue_tryreceive(u32 equeue_id, vm::ptr<sys_event_t> event_array,
 {
 	sys_event.trace("sys_event_queue_tryreceive(equeue_id=0x%x, event_array=*0x%x, size=%d, number=*0x%x)", equeue_id, event_array, size, number);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto queue = idm::get<lv2_event_queue_t>(equeue_id);
+	const auto queue = lv2_lock_object<lv2_event_queue_t>(equeue_id, lv2_lock);
 
 	if (!queue)
 	{
@@ -182,15 +255,18 @@ s32 sys_event_queue_tryreceive(u32 equeue_id, vm::ptr<sys_event_t> event_array,
 		return CELL_EINVAL;
 	}
 
+	// threads already waiting get events first
+	queue->notify(lv2_lock);
+
 	s32 count = 0;
 
-	while (queue->sq.empty() && count < size && queue->events.size())
+	lv2_event_queue_t::event_type event;
+
+	while (queue->sq.empty() && count < size && queue->pop(lv2_lock, event))
 	{
 		auto& dest = event_array[count++];
 
-		std::tie(dest.source, dest.data1, dest.data2, dest.data3) = queue->events.front();
-
-		queue->events.pop_front();
+		std::tie(dest.source, dest.data1, dest.data2, dest.data3) = event;
 	}
 
 	*number = count;
@@ -204,9 +280,9 @@ s32 sys_event_queue_receive(PPUThread& ppu, u32 equeue_id, vm::ptr<sys_event_t>
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto queue = idm::get<lv2_event_queue_t>(equeue_id);
+	const auto queue = lv2_lock_object<lv2_event_queue_t>(equeue_id, lv2_lock);
 
 	if (!queue)
 	{
@@ -218,12 +294,18 @@ s32 sys_event_queue_receive(PPUThread& ppu, u32 equeue_id, vm::ptr<sys_event_t>
 		return CELL_EINVAL;
 	}
 
-	if (queue->events.size())
+	// register before checking for events, so push() will notify this thread
+	lv2_event_queue_t::receiver_t receiver(*queue);
+
+	// threads already waiting get events first
+	queue->notify(lv2_lock);
+
+	lv2_event_queue_t::event_type event;
+
+	if (queue->pop(lv2_lock, event))
 	{
 		// event data is returned in registers (dummy_event is not used)
-		std::tie(ppu.GPR[4], ppu.GPR[5], ppu.GPR[6], ppu.GPR[7]) = queue->events.front();
-
-		queue->events.pop_front();
+		std::tie(ppu.GPR[4], ppu.GPR[5], ppu.GPR[6], ppu.GPR[7]) = event;
 
 		return CELL_OK;
 	}
@@ -231,28 +313,28 @@ s32 sys_event_queue_receive(PPUThread& ppu, u32 equeue_id, vm::ptr<sys_event_t>
 	// cause (if cancelled) will be returned in r3
 	ppu.GPR[3] = 0;
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, queue->sq);
 
+	// wake up the thread on timeout (notified under the queue lock, so the notification can't be missed)
+	const auto wakeup = !timeout ? nullptr : std::make_unique<scope_timer_t>(start_time + timeout, [queue, thread = ppu.shared_from_this()](u64) -> u64
+	{
+		std::lock_guard<std::mutex> lock(queue->lock);
+
+		thread->cv.notify_one();
+		return 0;
+	});
+
 	while (!ppu.unsignal())
 	{
 		CHECK_EMU_STATUS;
 
-		if (timeout)
+		if (timeout && get_system_time() - start_time >= timeout)
 		{
-			const u64 passed = get_system_time() - start_time;
-
-			if (passed >= timeout)
-			{
-				return CELL_ETIMEDOUT;
-			}
-
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
-		}
-		else
-		{
-			ppu.cv.wait(lv2_lock);
+			return CELL_ETIMEDOUT;
 		}
+
+		ppu.cv.wait(lv2_lock);
 	}
 
 	if (ppu.GPR[3])
@@ -273,16 +355,16 @@ s32 sys_event_queue_drain(u32 equeue_id)
 {
 	sys_event.trace("sys_event_queue_drain(equeue_id=0x%x)", equeue_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto queue = idm::get<lv2_event_queue_t>(equeue_id);
+	const auto queue = lv2_lock_object<lv2_event_queue_t>(equeue_id, lv2_lock);
 
 	if (!queue)
 	{
 		return CELL_ESRCH;
 	}
 
-	queue->events.clear();
+	queue->clear(lv2_lock);
 
 	return CELL_OK;
 }
@@ -306,9 +388,9 @@ s32 sys_event_port_destroy(u32 eport_id)
 {
 	sys_event.warning("sys_event_port_destroy(eport_id=0x%x)", eport_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto port = idm::get<lv2_event_port_t>(eport_id);
+	const auto port = lv2_lock_object<lv2_event_port_t>(eport_id, lv2_lock);
 
 	if (!port)
 	{
@@ -329,9 +411,9 @@ s32 sys_event_port_connect_local(u32 eport_id, u32 equeue_id)
 {
 	sys_event.warning("sys_event_port_connect_local(eport_id=0x%x, equeue_id=0x%x)", eport_id, equeue_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto port = idm::get<lv2_event_port_t>(eport_id);
+	const auto port = lv2_lock_object<lv2_event_port_t>(eport_id, lv2_lock);
 	const auto queue = idm::get<lv2_event_queue_t>(equeue_id);
 
 	if (!port || !queue)
@@ -358,9 +440,9 @@ s32 sys_event_port_disconnect(u32 eport_id)
 {
 	sys_event.warning("sys_event_port_disconnect(eport_id=0x%x)", eport_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto port = idm::get<lv2_event_port_t>(eport_id);
+	const auto port = lv2_lock_object<lv2_event_port_t>(eport_id, lv2_lock);
 
 	if (!port)
 	{
@@ -385,9 +467,9 @@ s32 sys_event_port_send(u32 eport_id, u64 data1, u64 data2, u64 data3)
 {
 	sys_event.trace("sys_event_port_send(eport_id=0x%x, data1=0x%llx, data2=0x%llx, data3=0x%llx)", eport_id, data1, data2, data3);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto port = idm::get<lv2_event_port_t>(eport_id);
+	const auto port = lv2_lock_object<lv2_event_port_t>(eport_id, lv2_lock);
 
 	if (!port)
 	{
@@ -396,19 +478,20 @@ s32 sys_event_port_send(u32 eport_id, u64 data1, u64 data2, u64 data3)
 
 	const auto queue = port->queue.lock();
 
+	// release the port lock (the queue lock is acquired by push() only if there are receivers)
+	lv2_lock.unlock();
+
 	if (!queue)
 	{
 		return CELL_ENOTCONN;
 	}
 
-	if (queue->events.size() >= queue->size)
+	const u64 source = port->name ? port->name : ((u64)process_getpid() << 32) | (u64)eport_id;
+
+	if (!queue->push(source, data1, data2, data3))
 	{
 		return CELL_EBUSY;
 	}
 
-	const u64 source = port->name ? port->name : ((u64)process_getpid() << 32) | (u64)eport_id;
-
-	queue->push(lv2_lock, source, data1, data2, data3);
-
 	return CELL_OK;
 }
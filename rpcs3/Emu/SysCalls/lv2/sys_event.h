@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -65,8 +66,19 @@ struct sys_event_t
 	be_t<u64> data3;
 };
 
+// Event queue: events are stored in a bounded ring (sized by the queue size) written without a lock,
+// reading events and waiting (sq) require the queue lock, so there is only one consumer at a time
 struct lv2_event_queue_t
 {
+	// tuple elements: source, data1, data2, data3
+	using event_type = std::tuple<u64, u64, u64, u64>;
+
+	struct event_cell_t
+	{
+		std::atomic<u64> seq{ 0 }; // ring position + 1 after the event is written
+		event_type data;
+	};
+
 	const u32 id;
 	const u32 protocol;
 	const s32 type;
@@ -74,14 +86,60 @@ struct lv2_event_queue_t
 	const u64 key;
 	const s32 size;
 
-	// tuple elements: source, data1, data2, data3
-	std::deque<std::tuple<u64, u64, u64, u64>> events;
+private:
+	const u32 m_mask; // ring capacity - 1 (capacity is a power of 2 >= size)
+	const std::unique_ptr<event_cell_t[]> m_cells;
 
+	std::atomic<s32> m_count{ 0 }; // events reserved by push() and not yet removed (limited by size)
+	std::atomic<u64> m_push_pos{ 0 };
+	u64 m_pop_pos = 0; // protected by lock
+
+	std::atomic<u32> m_receivers{ 0 }; // threads which may wait for events
+
+public:
 	sleep_queue_t sq;
 
+	std::mutex lock; // protects sq and event removal (LV2_LOCK isn't used)
+
 	lv2_event_queue_t(u32 protocol, s32 type, u64 name, u64 key, s32 size);
 
-	void push(lv2_lock_t& lv2_lock, u64 source, u64 data1, u64 data2, u64 data3);
+	// Add event (returns false if the queue is full); the queue lock must not be held, it's acquired if there are receivers
+	bool push(u64 source, u64 data1, u64 data2, u64 data3);
+
+	// Remove the oldest event (returns false if there are no events)
+	bool pop(lv2_lock_t& lv2_lock, event_type& event);
+
+	// Remove all events
+	void clear(lv2_lock_t& lv2_lock);
+
+	// Current number of events (including events being added)
+	s32 count() const
+	{
+		return m_count;
+	}
+
+	// Hand events over to the waiting threads (in sq order)
+	void notify(lv2_lock_t& lv2_lock);
+
+	// Receiver registration, must exist while checking for events and waiting for them
+	class receiver_t final
+	{
+		lv2_event_queue_t& m_queue;
+
+	public:
+		receiver_t(lv2_event_queue_t& queue)
+			: m_queue(queue)
+		{
+			m_queue.m_receivers++;
+		}
+
+		receiver_t(const receiver_t&) = delete;
+
+		~receiver_t()
+		{
+			m_queue.m_receivers--;
+		}
+	};
 };
 
 struct lv2_event_port_t
@@ -91,6 +149,8 @@ struct lv2_event_port_t
 
 	std::weak_ptr<lv2_event_queue_t> queue; // event queue this port is connected to
 
+	std::mutex lock; // protects queue (LV2_LOCK isn't used)
+
 	lv2_event_port_t(s32 type, u64 name)
 		: type(type)
 		, name(name)
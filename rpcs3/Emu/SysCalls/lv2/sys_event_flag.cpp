@@ -11,10 +11,11 @@
 SysCallBase sys_event_flag("sys_event_flag");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 void lv2_event_flag_t::notify_all(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
 	auto pred = [this](sleep_queue_t::value_type& thread) -> bool
 	{
@@ -41,8 +42,8 @@ void lv2_event_flag_t::notify_all(lv2_lock_t& lv2_lock)
 		return false;
 	};
 
-	// check all waiters; protocol is ignored in current implementation
-	sq.erase(std::remove_if(sq.begin(), sq.end(), pred), sq.end());
+	// check all waiters
+	sq.erase_if(pred);
 }
 
 s32 sys_event_flag_create(vm::ptr<u32> id, vm::ptr<sys_event_flag_attribute_t> attr, u64 init)
@@ -85,9 +86,9 @@ s32 sys_event_flag_destroy(u32 id)
 {
 	sys_event_flag.warning("sys_event_flag_destroy(id=0x%x)", id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -115,8 +116,6 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 	ppu.GPR[4] = bitptn;
 	ppu.GPR[5] = mode;
 
-	LV2_LOCK;
-
 	if (result) *result = 0; // This is very annoying.
 
 	if (!lv2_event_flag_t::check_mode(mode))
@@ -125,7 +124,9 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 		return CELL_EINVAL;
 	}
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	LV2_DEFER_LOCK;
+
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -146,7 +147,7 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, eflag->sq);
 
 	while (!ppu.unsignal())
@@ -164,7 +165,7 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -191,8 +192,6 @@ s32 sys_event_flag_trywait(u32 id, u64 bitptn, u32 mode, vm::ptr<u64> result)
 {
 	sys_event_flag.trace("sys_event_flag_trywait(id=0x%x, bitptn=0x%llx, mode=0x%x, result=*0x%x)", id, bitptn, mode, result);
 
-	LV2_LOCK;
-
 	if (result) *result = 0; // This is very annoying.
 
 	if (!lv2_event_flag_t::check_mode(mode))
@@ -201,7 +200,9 @@ s32 sys_event_flag_trywait(u32 id, u64 bitptn, u32 mode, vm::ptr<u64> result)
 		return CELL_EINVAL;
 	}
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	LV2_DEFER_LOCK;
+
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -224,9 +225,9 @@ s32 sys_event_flag_set(u32 id, u64 bitptn)
 {
 	sys_event_flag.trace("sys_event_flag_set(id=0x%x, bitptn=0x%llx)", id, bitptn);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -245,9 +246,9 @@ s32 sys_event_flag_clear(u32 id, u64 bitptn)
 {
 	sys_event_flag.trace("sys_event_flag_clear(id=0x%x, bitptn=0x%llx)", id, bitptn);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -263,14 +264,14 @@ s32 sys_event_flag_cancel(u32 id, vm::ptr<u32> num)
 {
 	sys_event_flag.trace("sys_event_flag_cancel(id=0x%x, num=*0x%x)", id, num);
 
-	LV2_LOCK;
-
 	if (num)
 	{
 		*num = 0;
 	}
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	LV2_DEFER_LOCK;
+
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -310,14 +311,14 @@ s32 sys_event_flag_get(u32 id, vm::ptr<u64> flags)
 {
 	sys_event_flag.trace("sys_event_flag_get(id=0x%x, flags=*0x%x)", id, flags);
 
-	LV2_LOCK;
-
 	if (!flags)
 	{
 		return CELL_EFAULT;
 	}
 
-	const auto eflag = idm::get<lv2_event_flag_t>(id);
+	LV2_DEFER_LOCK;
+
+	const auto eflag = lv2_lock_object<lv2_event_flag_t>(id, lv2_lock);
 
 	if (!eflag)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -41,11 +42,14 @@ struct lv2_event_flag_t
 
 	sleep_queue_t sq;
 
+	std::mutex lock;
+
 	lv2_event_flag_t(u64 pattern, u32 protocol, s32 type, u64 name)
 		: pattern(pattern)
 		, protocol(protocol)
 		, type(type)
 		, name(name)
+		, sq(lv2_sync_priority(protocol))
 	{
 	}
 
@@ -5,16 +5,18 @@
 #include "Emu/SysCalls/SysCalls.h"
 
 #include "Emu/Cell/PPUThread.h"
+#include "sys_sync.h"
 #include "sys_lwmutex.h"
 #include "sys_lwcond.h"
 
 SysCallBase sys_lwcond("sys_lwcond");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
-void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& mutex, bool mode2)
+void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type thread, bool mode2)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
 	auto& ppu = static_cast<PPUThread&>(*thread);
 
@@ -24,7 +26,7 @@ void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type& thre
 	{
 		if (!mutex->signaled)
 		{
-			return mutex->sq.emplace_back(thread);
+			return mutex->sq.push(*thread);
 		}
 
 		mutex->signaled--;
@@ -40,7 +42,14 @@ s32 _sys_lwcond_create(vm::ptr<u32> lwcond_id, u32 lwmutex_id, vm::ptr<sys_lwcon
 {
 	sys_lwcond.warning("_sys_lwcond_create(lwcond_id=*0x%x, lwmutex_id=0x%x, control=*0x%x, name=0x%llx, arg5=0x%x)", lwcond_id, lwmutex_id, control, name, arg5);
 
-	*lwcond_id = idm::make<lv2_lwcond_t>(name);
+	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+
+	if (!mutex)
+	{
+		return CELL_ESRCH;
+	}
+
+	*lwcond_id = idm::make<lv2_lwcond_t>(mutex, name);
 
 	return CELL_OK;
 }
@@ -49,9 +58,9 @@ s32 _sys_lwcond_destroy(u32 lwcond_id)
 {
 	sys_lwcond.warning("_sys_lwcond_destroy(lwcond_id=0x%x)", lwcond_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_lwcond_t>(lwcond_id);
+	const auto cond = lv2_lock_object<lv2_lwcond_t>(lwcond_id, lv2_lock);
 
 	if (!cond)
 	{
@@ -72,12 +81,12 @@ s32 _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id, u32 mod
 {
 	sys_lwcond.trace("_sys_lwcond_signal(lwcond_id=0x%x, lwmutex_id=0x%x, ppu_thread_id=0x%x, mode=%d)", lwcond_id, lwmutex_id, ppu_thread_id, mode);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_lwcond_t>(lwcond_id);
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto cond = lv2_lock_object<lv2_lwcond_t>(lwcond_id, lv2_lock);
 
-	if (!cond || (lwmutex_id && !mutex))
+	// the lightweight mutex (if specified) must be the associated one
+	if (!cond || (lwmutex_id && idm::get<lv2_lwmutex_t>(lwmutex_id) != cond->mutex))
 	{
 		return CELL_ESRCH;
 	}
@@ -113,11 +122,13 @@ s32 _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id, u32 mod
 		}
 	}
 
-	// signal specified waiting thread
-	cond->notify(lv2_lock, *found, mutex, mode == 2);
+	// signal specified waiting thread (removed first, it may be added to the mutex sleep queue)
+	const auto thread = *found;
 
 	cond->sq.erase(found);
 
+	cond->notify(lv2_lock, thread, mode == 2);
+
 	return CELL_OK;
 }
 
@@ -125,12 +136,12 @@ s32 _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 {
 	sys_lwcond.trace("_sys_lwcond_signal_all(lwcond_id=0x%x, lwmutex_id=0x%x, mode=%d)", lwcond_id, lwmutex_id, mode);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_lwcond_t>(lwcond_id);
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto cond = lv2_lock_object<lv2_lwcond_t>(lwcond_id, lv2_lock);
 
-	if (!cond || (lwmutex_id && !mutex))
+	// the lightweight mutex (if specified) must be the associated one
+	if (!cond || (lwmutex_id && idm::get<lv2_lwmutex_t>(lwmutex_id) != cond->mutex))
 	{
 		return CELL_ESRCH;
 	}
@@ -143,16 +154,16 @@ s32 _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 	// mode 1: lightweight mutex was initially owned by the calling thread
 	// mode 2: lightweight mutex was not owned by the calling thread and waiter hasn't been increased
 
-	// signal all waiting threads; protocol is ignored in current implementation
-	for (auto& thread : cond->sq)
-	{
-		cond->notify(lv2_lock, thread, mutex, mode == 2);
-	}
-
 	// in mode 1, return the amount of threads signaled
 	const s32 result = mode == 2 ? CELL_OK : static_cast<s32>(cond->sq.size());
 
-	cond->sq.clear();
+	// signal all waiting threads; protocol is ignored in current implementation
+	while (!cond->sq.empty())
+	{
+		const auto thread = cond->sq.front();
+		cond->sq.pop_front();
+		cond->notify(lv2_lock, thread, mode == 2);
+	}
 
 	return result;
 }
@@ -163,16 +174,17 @@ s32 _sys_lwcond_queue_wait(PPUThread& ppu, u32 lwcond_id, u32 lwmutex_id, u64 ti
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto cond = idm::get<lv2_lwcond_t>(lwcond_id);
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto cond = lv2_lock_object<lv2_lwcond_t>(lwcond_id, lv2_lock);
 
-	if (!cond || !mutex)
+	if (!cond || idm::get<lv2_lwmutex_t>(lwmutex_id) != cond->mutex)
 	{
 		return CELL_ESRCH;
 	}
 
+	const auto& mutex = cond->mutex;
+
 	// finalize unlocking the mutex
 	mutex->unlock(lv2_lock);
 
@@ -180,7 +192,7 @@ s32 _sys_lwcond_queue_wait(PPUThread& ppu, u32 lwcond_id, u32 lwmutex_id, u64 ti
 	sleep_queue_entry_t waiter(ppu, cond->sq);
 
 	// potential mutex waiter (not added immediately)
-	sleep_queue_entry_t mutex_waiter(ppu, cond->sq, defer_sleep);
+	sleep_queue_entry_t mutex_waiter(ppu, mutex->sq, defer_sleep);
 
 	while (!ppu.unsignal())
 	{
@@ -205,7 +217,7 @@ s32 _sys_lwcond_queue_wait(PPUThread& ppu, u32 lwcond_id, u32 lwmutex_id, u64 ti
 				}
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
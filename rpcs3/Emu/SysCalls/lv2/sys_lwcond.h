@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Utilities/SleepQueue.h"
+#include "sys_lwmutex.h"
 
 namespace vm { using namespace ps3; }
 
@@ -19,16 +19,21 @@ struct sys_lwcond_t
 
 struct lv2_lwcond_t
 {
+	const std::shared_ptr<lv2_lwmutex_t> mutex; // associated lightweight mutex
 	const u64 name;
 
 	sleep_queue_t sq;
 
-	lv2_lwcond_t(u64 name)
-		: name(name)
+	std::mutex& lock; // lock of the associated lightweight mutex
+
+	lv2_lwcond_t(const std::shared_ptr<lv2_lwmutex_t>& mutex, u64 name)
+		: mutex(mutex)
+		, name(name)
+		, lock(mutex->lock)
 	{
 	}
 
-	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& mutex, bool mode2);
+	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type thread, bool mode2);
 };
 
 // Aux
@@ -11,10 +11,11 @@
 SysCallBase sys_lwmutex("sys_lwmutex");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 void lv2_lwmutex_t::unlock(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
 	if (signaled)
 	{
@@ -60,9 +61,9 @@ s32 _sys_lwmutex_destroy(u32 lwmutex_id)
 {
 	sys_lwmutex.warning("_sys_lwmutex_destroy(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto mutex = lv2_lock_object<lv2_lwmutex_t>(lwmutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -85,9 +86,9 @@ s32 _sys_lwmutex_lock(PPUThread& ppu, u32 lwmutex_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto mutex = lv2_lock_object<lv2_lwmutex_t>(lwmutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -101,7 +102,7 @@ s32 _sys_lwmutex_lock(PPUThread& ppu, u32 lwmutex_id, u64 timeout)
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, mutex->sq);
 
 	while (!ppu.unsignal())
@@ -117,7 +118,7 @@ s32 _sys_lwmutex_lock(PPUThread& ppu, u32 lwmutex_id, u64 timeout)
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -132,9 +133,9 @@ s32 _sys_lwmutex_trylock(u32 lwmutex_id)
 {
 	sys_lwmutex.trace("_sys_lwmutex_trylock(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto mutex = lv2_lock_object<lv2_lwmutex_t>(lwmutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -155,9 +156,9 @@ s32 _sys_lwmutex_unlock(u32 lwmutex_id)
 {
 	sys_lwmutex.trace("_sys_lwmutex_unlock(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_lwmutex_t>(lwmutex_id);
+	const auto mutex = lv2_lock_object<lv2_lwmutex_t>(lwmutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -56,9 +57,12 @@ struct lv2_lwmutex_t
 
 	sleep_queue_t sq;
 
+	std::mutex lock; // protects sq and waiting (LV2_LOCK isn't used), also used by associated lwconds
+
 	lv2_lwmutex_t(u32 protocol, u64 name)
 		: protocol(protocol)
 		, name(name)
+		, sq(lv2_sync_priority(protocol))
 	{
 	}
 
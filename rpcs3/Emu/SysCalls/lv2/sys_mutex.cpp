@@ -11,17 +11,18 @@
 SysCallBase sys_mutex("sys_mutex");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 void lv2_mutex_t::unlock(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
 	owner.reset();
 
 	if (sq.size())
 	{
-		// pick new owner; protocol is ignored in current implementation
-		owner = sq.front();
+		// pick new owner
+		owner = std::static_pointer_cast<CPUThread>(sq.front()->shared_from_this());
 
 		if (!owner->signal())
 		{
@@ -72,9 +73,9 @@ s32 sys_mutex_destroy(u32 mutex_id)
 {
 	sys_mutex.warning("sys_mutex_destroy(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_mutex_t>(mutex_id);
+	const auto mutex = lv2_lock_object<lv2_mutex_t>(mutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -102,9 +103,9 @@ s32 sys_mutex_lock(PPUThread& ppu, u32 mutex_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_mutex_t>(mutex_id);
+	const auto mutex = lv2_lock_object<lv2_mutex_t>(mutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -137,7 +138,7 @@ s32 sys_mutex_lock(PPUThread& ppu, u32 mutex_id, u64 timeout)
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, mutex->sq);
 
 	while (!ppu.unsignal())
@@ -153,7 +154,7 @@ s32 sys_mutex_lock(PPUThread& ppu, u32 mutex_id, u64 timeout)
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -174,9 +175,9 @@ s32 sys_mutex_trylock(PPUThread& ppu, u32 mutex_id)
 {
 	sys_mutex.trace("sys_mutex_trylock(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_mutex_t>(mutex_id);
+	const auto mutex = lv2_lock_object<lv2_mutex_t>(mutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -216,9 +217,9 @@ s32 sys_mutex_unlock(PPUThread& ppu, u32 mutex_id)
 {
 	sys_mutex.trace("sys_mutex_unlock(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto mutex = idm::get<lv2_mutex_t>(mutex_id);
+	const auto mutex = lv2_lock_object<lv2_mutex_t>(mutex_id, lv2_lock);
 
 	if (!mutex)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -33,10 +34,13 @@ struct lv2_mutex_t
 
 	sleep_queue_t sq;
 
+	std::mutex lock; // object lock (also used by associated condition variables)
+
 	lv2_mutex_t(bool recursive, u32 protocol, u64 name)
 		: recursive(recursive)
 		, protocol(protocol)
 		, name(name)
+		, sq(lv2_sync_priority(protocol))
 	{
 	}
 
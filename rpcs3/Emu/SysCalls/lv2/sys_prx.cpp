@@ -7,6 +7,7 @@
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/SysCalls/ModuleManager.h"
 #include "Emu/Cell/PPUInstrTable.h"
+#include "Emu/CPU/CPUProfiler.h"
 
 #include "Emu/FS/VFS.h"
 #include "Emu/FS/vfsFile.h"
@@ -50,6 +51,15 @@ s32 prx_load_module(std::string path, u64 flags, vm::ptr<sys_prx_load_module_opt
 
 	for (auto &module_ : info.modules)
 	{
+		// register function symbols of all exports (including module_start/module_stop) for the profiler
+		for (auto& f : module_.second.exports)
+		{
+			if (vm::check_addr(f.second, 8))
+			{
+				cpu_profiler_add_symbol(vm::read32(f.second), get_ps3_function_name(f.first));
+			}
+		}
+
 		if (module_.first == "")
 			continue;
 
@@ -124,6 +134,8 @@ s32 prx_load_module(std::string path, u64 flags, vm::ptr<sys_prx_load_module_opt
 
 	const auto decoder_cache = fxm::get<ppu_decoder_cache_t>();
 
+	extern void ppu_precompile(u32 addr, u32 size, bool async);
+
 	for (auto& seg : info.segments)
 	{
 		const u32 addr = seg.begin.addr();
@@ -132,6 +144,12 @@ s32 prx_load_module(std::string path, u64 flags, vm::ptr<sys_prx_load_module_opt
 		if (vm::check_addr(addr, size))
 		{
 			decoder_cache->initialize(addr, size);
+
+			if (seg.flags & 0x1)
+			{
+				// don't block the calling PPU thread on compilation
+				ppu_precompile(addr, seg.size, true);
+			}
 		}
 		else
 		{
@@ -11,15 +11,16 @@
 SysCallBase sys_rwlock("sys_rwlock");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 void lv2_rwlock_t::notify_all(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, *this);
 
-	// pick a new writer if possible; protocol is ignored in current implementation
+	// pick a new writer if possible
 	if (!readers && !writer && wsq.size())
 	{
-		writer = wsq.front();
+		writer = std::static_pointer_cast<CPUThread>(wsq.front()->shared_from_this());
 
 		if (!writer->signal())
 		{
@@ -78,9 +79,9 @@ s32 sys_rwlock_destroy(u32 rw_lock_id)
 {
 	sys_rwlock.warning("sys_rwlock_destroy(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -103,9 +104,9 @@ s32 sys_rwlock_rlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -122,7 +123,7 @@ s32 sys_rwlock_rlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, rwlock->rsq);
 
 	while (!ppu.unsignal())
@@ -138,7 +139,7 @@ s32 sys_rwlock_rlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -158,9 +159,9 @@ s32 sys_rwlock_tryrlock(u32 rw_lock_id)
 {
 	sys_rwlock.trace("sys_rwlock_tryrlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -184,9 +185,9 @@ s32 sys_rwlock_runlock(u32 rw_lock_id)
 {
 	sys_rwlock.trace("sys_rwlock_runlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -212,9 +213,9 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -233,7 +234,7 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, rwlock->wsq);
 
 	while (!ppu.unsignal())
@@ -249,7 +250,7 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 				// if the last waiter quit the writer sleep queue, readers must acquire the lock
 				if (!rwlock->writer && rwlock->wsq.size() == 1)
 				{
-					if (rwlock->wsq.front().get() != &ppu)
+					if (rwlock->wsq.front() != &ppu)
 					{
 						throw EXCEPTION("Unexpected");
 					}
@@ -261,7 +262,7 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -281,9 +282,9 @@ s32 sys_rwlock_trywlock(PPUThread& ppu, u32 rw_lock_id)
 {
 	sys_rwlock.trace("sys_rwlock_trywlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
@@ -309,9 +310,9 @@ s32 sys_rwlock_wunlock(PPUThread& ppu, u32 rw_lock_id)
 {
 	sys_rwlock.trace("sys_rwlock_wunlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto rwlock = idm::get<lv2_rwlock_t>(rw_lock_id);
+	const auto rwlock = lv2_lock_object<lv2_rwlock_t>(rw_lock_id, lv2_lock);
 
 	if (!rwlock)
 	{
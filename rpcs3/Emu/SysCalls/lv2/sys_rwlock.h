@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -30,9 +31,13 @@ struct lv2_rwlock_t
 	sleep_queue_t rsq; // threads trying to acquire readed lock
 	sleep_queue_t wsq; // threads trying to acquire writer lock
 
+	std::mutex lock;
+
 	lv2_rwlock_t(u32 protocol, u64 name)
 		: protocol(protocol)
 		, name(name)
+		, rsq(lv2_sync_priority(protocol))
+		, wsq(lv2_sync_priority(protocol))
 	{
 	}
 
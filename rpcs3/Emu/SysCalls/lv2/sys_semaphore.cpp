@@ -11,6 +11,7 @@
 SysCallBase sys_semaphore("sys_semaphore");
 
 extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
 
 s32 sys_semaphore_create(vm::ptr<u32> sem_id, vm::ptr<sys_semaphore_attribute_t> attr, s32 initial_val, s32 max_val)
 {
@@ -50,9 +51,9 @@ s32 sys_semaphore_destroy(u32 sem_id)
 {
 	sys_semaphore.warning("sys_semaphore_destroy(sem_id=0x%x)", sem_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto sem = idm::get<lv2_sema_t>(sem_id);
+	const auto sem = lv2_lock_object<lv2_sema_t>(sem_id, lv2_lock);
 
 	if (!sem)
 	{
@@ -75,9 +76,9 @@ s32 sys_semaphore_wait(PPUThread& ppu, u32 sem_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto sem = idm::get<lv2_sema_t>(sem_id);
+	const auto sem = lv2_lock_object<lv2_sema_t>(sem_id, lv2_lock);
 
 	if (!sem)
 	{
@@ -91,7 +92,7 @@ s32 sys_semaphore_wait(PPUThread& ppu, u32 sem_id, u64 timeout)
 		return CELL_OK;
 	}
 
-	// add waiter; protocol is ignored in current implementation
+	// add waiter (in the order defined by protocol)
 	sleep_queue_entry_t waiter(ppu, sem->sq);
 
 	while (!ppu.unsignal())
@@ -107,7 +108,7 @@ s32 sys_semaphore_wait(PPUThread& ppu, u32 sem_id, u64 timeout)
 				return CELL_ETIMEDOUT;
 			}
 
-			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(timeout - passed));
+			ppu.cv.wait_for(lv2_lock, std::chrono::microseconds(get_host_wait_time(timeout - passed)));
 		}
 		else
 		{
@@ -122,9 +123,9 @@ s32 sys_semaphore_trywait(u32 sem_id)
 {
 	sys_semaphore.trace("sys_semaphore_trywait(sem_id=0x%x)", sem_id);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto sem = idm::get<lv2_sema_t>(sem_id);
+	const auto sem = lv2_lock_object<lv2_sema_t>(sem_id, lv2_lock);
 
 	if (!sem)
 	{
@@ -145,9 +146,9 @@ s32 sys_semaphore_post(u32 sem_id, s32 count)
 {
 	sys_semaphore.trace("sys_semaphore_post(sem_id=0x%x, count=%d)", sem_id, count);
 
-	LV2_LOCK;
+	LV2_DEFER_LOCK;
 
-	const auto sem = idm::get<lv2_sema_t>(sem_id);
+	const auto sem = lv2_lock_object<lv2_sema_t>(sem_id, lv2_lock);
 
 	if (!sem)
 	{
@@ -191,14 +192,14 @@ s32 sys_semaphore_get_value(u32 sem_id, vm::ptr<s32> count)
 {
 	sys_semaphore.trace("sys_semaphore_get_value(sem_id=0x%x, count=*0x%x)", sem_id, count);
 
-	LV2_LOCK;
-
 	if (!count)
 	{
 		return CELL_EFAULT;
 	}
 
-	const auto sem = idm::get<lv2_sema_t>(sem_id);
+	LV2_DEFER_LOCK;
+
+	const auto sem = lv2_lock_object<lv2_sema_t>(sem_id, lv2_lock);
 
 	if (!sem)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/SleepQueue.h"
+#include "sys_sync.h"
 
 namespace vm { using namespace ps3; }
 
@@ -29,11 +30,14 @@ struct lv2_sema_t
 
 	sleep_queue_t sq;
 
+	std::mutex lock;
+
 	lv2_sema_t(u32 protocol, s32 max, u64 name, s32 value)
 		: protocol(protocol)
 		, max(max)
 		, name(name)
 		, value(value)
+		, sq(lv2_sync_priority(protocol))
 	{
 	}
 };
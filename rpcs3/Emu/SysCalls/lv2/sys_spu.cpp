@@ -7,6 +7,7 @@
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/FS/vfsStreamMemory.h"
+#include "Emu/FS/VFS.h"
 #include "Emu/FS/vfsFile.h"
 #include "Loader/ELF32.h"
 #include "Crypto/unself.h"
@@ -33,6 +34,117 @@ u32 LoadSpuImage(vfsStream& stream, u32& spu_ep)
 	return spu_offset;
 }
 
+// SPU ELF file loaded in host memory
+struct spu_image_file_t
+{
+	u64 size; // file size
+	s64 mtime; // file modification time
+	u32 entry_point;
+	std::vector<std::pair<u32, std::vector<u8>>> segs; // loaded segments (LS address, data)
+};
+
+// Cache of SPU ELF files (by local path), an entry is reused while the file is unchanged
+struct spu_image_cache_t
+{
+	std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const spu_image_file_t>> map;
+	u32 hits = 0;
+	u32 misses = 0;
+};
+
+s32 LoadSpuImage(const std::string& path, u32& spu_ep, u32 addr)
+{
+	const auto cache = fxm::get_always<spu_image_cache_t>();
+
+	std::string local_path;
+	fs::stat_t info{};
+
+	// files which can't be checked for modification aren't cached
+	const bool cacheable = Emu.GetVFS().GetDevice(path, local_path) && fs::stat(local_path, info) && !info.is_directory;
+
+	std::shared_ptr<const spu_image_file_t> image;
+
+	if (cacheable)
+	{
+		std::lock_guard<std::mutex> lock(cache->mutex);
+
+		const auto found = cache->map.find(local_path);
+
+		if (found != cache->map.end() && found->second->size == info.size && found->second->mtime == info.mtime)
+		{
+			image = found->second;
+
+			sys_spu.notice("SPU image '%s' loaded from cache (hits=%u, misses=%u)", path, ++cache->hits, cache->misses);
+		}
+	}
+
+	if (!image)
+	{
+		vfsFile f(path);
+
+		if (!f.IsOpened())
+		{
+			sys_spu.error("SPU image '%s' not found!", path);
+			return CELL_ENOENT;
+		}
+
+		SceHeader hdr;
+		hdr.Load(f);
+
+		if (hdr.CheckMagic())
+		{
+			sys_spu.error("SPU image '%s' is encrypted! Decrypt SELF and try again.", path);
+			Emu.Pause();
+			return CELL_ENOENT;
+		}
+
+		f.Seek(0);
+
+		loader::handlers::elf32 h;
+		h.init(f);
+
+		auto file = std::make_shared<spu_image_file_t>();
+
+		file->size = info.size;
+		file->mtime = info.mtime;
+		file->entry_point = h.m_ehdr.data_be.e_entry;
+
+		// read LOAD segments (as elf32::load_data() does)
+		for (auto& phdr : h.m_phdrs)
+		{
+			if (phdr.data_be.p_type == 0x00000001 && phdr.data_be.p_memsz && phdr.data_be.p_filesz)
+			{
+				std::vector<u8> data(phdr.data_be.p_filesz);
+
+				f.Seek(h.get_stream_offset() + phdr.data_be.p_offset);
+				f.Read(data.data(), data.size());
+
+				file->segs.emplace_back(phdr.data_be.p_vaddr, std::move(data));
+			}
+		}
+
+		image = std::move(file);
+
+		if (cacheable)
+		{
+			std::lock_guard<std::mutex> lock(cache->mutex);
+
+			cache->map[local_path] = image;
+			cache->misses++;
+		}
+	}
+
+	// copy segments to LS
+	for (auto& seg : image->segs)
+	{
+		std::memcpy(vm::base(addr + seg.first), seg.second.data(), seg.second.size());
+	}
+
+	spu_ep = image->entry_point;
+
+	return CELL_OK;
+}
+
 s32 spu_image_import(sys_spu_image& img, u32 src, u32 type)
 {
 	vfsStreamMemory f(src);
@@ -63,28 +175,16 @@ s32 sys_spu_image_open(vm::ptr<sys_spu_image> img, vm::cptr<char> path)
 {
 	sys_spu.warning("sys_spu_image_open(img=*0x%x, path=*0x%x)", img, path);
 
-	vfsFile f(path.get_ptr());
-	if(!f.IsOpened())
-	{
-		sys_spu.error("sys_spu_image_open error: '%s' not found!", path.get_ptr());
-		return CELL_ENOENT;
-	}
+	const u32 offset = vm::alloc(256 * 1024, vm::main);
 
-	SceHeader hdr;
-	hdr.Load(f);
+	u32 entry;
 
-	if (hdr.CheckMagic())
+	if (const s32 res = LoadSpuImage(path.get_ptr(), entry, offset))
 	{
-		sys_spu.error("sys_spu_image_open error: '%s' is encrypted! Decrypt SELF and try again.", path.get_ptr());
-		Emu.Pause();
-		return CELL_ENOENT;
+		vm::dealloc(offset, vm::main);
+		return res;
 	}
 
-	f.Seek(0);
-
-	u32 entry;
-	u32 offset = LoadSpuImage(f, entry);
-
 	img->type = SYS_SPU_IMAGE_TYPE_USER;
 	img->entry_point = entry;
 	img->addr = offset; // TODO: writing actual segment info
@@ -313,6 +413,7 @@ s32 sys_spu_thread_group_start(u32 id)
 			// Copy SPU image:
 			// TODO: use segment info
 			std::memcpy(vm::base(t->offset), vm::base(image->addr), 256 * 1024);
+			t->ls_code_notify(0, 256 * 1024);
 
 			t->pc = image->entry_point;
 			t->run();
@@ -634,6 +735,8 @@ s32 sys_spu_thread_write_ls(u32 id, u32 lsa, u64 value, u32 type)
 	default: return CELL_EINVAL;
 	}
 
+	thread->ls_code_notify(lsa, type);
+
 	return CELL_OK;
 }
 
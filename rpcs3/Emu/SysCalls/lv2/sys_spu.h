@@ -183,7 +183,7 @@ struct lv2_spu_group_t
 
 		if (const auto queue = ep_run.lock())
 		{
-			queue->push(lv2_lock, SYS_SPU_THREAD_GROUP_EVENT_RUN_KEY, data1, data2, data3);
+			queue->push(SYS_SPU_THREAD_GROUP_EVENT_RUN_KEY, data1, data2, data3);
 		}
 	}
 
@@ -193,7 +193,7 @@ struct lv2_spu_group_t
 
 		if (const auto queue = ep_exception.lock())
 		{
-			queue->push(lv2_lock, SYS_SPU_THREAD_GROUP_EVENT_EXCEPTION_KEY, data1, data2, data3);
+			queue->push(SYS_SPU_THREAD_GROUP_EVENT_EXCEPTION_KEY, data1, data2, data3);
 		}
 	}
 
@@ -203,7 +203,7 @@ struct lv2_spu_group_t
 
 		if (const auto queue = ep_sysmodule.lock())
 		{
-			queue->push(lv2_lock, SYS_SPU_THREAD_GROUP_EVENT_SYSTEM_MODULE_KEY, data1, data2, data3);
+			queue->push(SYS_SPU_THREAD_GROUP_EVENT_SYSTEM_MODULE_KEY, data1, data2, data3);
 		}
 	}
 };
@@ -213,6 +213,7 @@ class PPUThread;
 
 void LoadSpuImage(vfsStream& stream, u32& spu_ep, u32 addr);
 u32 LoadSpuImage(vfsStream& stream, u32& spu_ep);
+s32 LoadSpuImage(const std::string& path, u32& spu_ep, u32 addr); // load SPU ELF file (cached in host memory)
 
 // Aux
 s32 spu_image_import(sys_spu_image& img, u32 src, u32 type);
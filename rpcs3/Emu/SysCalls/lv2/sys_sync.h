@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Emu/IdManager.h"
+
 namespace vm { using namespace ps3; }
 
 // attr_protocol (waiting scheduling policy)
@@ -40,3 +42,35 @@ enum
 	SYS_SYNC_ADAPTIVE     = 0x1000,
 	SYS_SYNC_NOT_ADAPTIVE = 0x2000,
 };
+
+// Check whether waiters are picked in priority order
+inline bool lv2_sync_priority(u32 protocol)
+{
+	return protocol == SYS_SYNC_PRIORITY || protocol == SYS_SYNC_PRIORITY_INHERIT;
+}
+
+// Lock ordering for lv2 objects protected by their own lock (sys_mutex, sys_cond, sys_rwlock, sys_semaphore, sys_event_flag,
+// sys_lwmutex, sys_lwcond, sys_event_queue, sys_event_port): LV2_LOCK (if required) is acquired first;
+// sys_cond and sys_lwcond use the lock of the associated mutex; sys_event_port lock is released before the queue lock is acquired;
+// no other lock of lv2 object may be acquired while holding one.
+
+// Get lv2 object and acquire its lock (returns nullptr if not found or destroyed before it was locked)
+template<typename T> std::shared_ptr<T> lv2_lock_object(u32 id, lv2_lock_t& lv2_lock)
+{
+	const auto object = idm::get<T>(id);
+
+	if (object)
+	{
+		lv2_lock = lv2_lock_t(object->lock);
+
+		// object is removed under its lock
+		if (idm::get<T>(id) != object)
+		{
+			lv2_lock.unlock();
+
+			return nullptr;
+		}
+	}
+
+	return object;
+}
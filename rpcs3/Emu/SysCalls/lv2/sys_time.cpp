@@ -1,7 +1,10 @@
 #include "stdafx.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/state.h"
 #include "Emu/SysCalls/SysCalls.h"
+#include "Emu/CPU/CPUThreadManager.h"
+#include "Emu/CPU/CPUThread.h"
 
 #include "sys_time.h"
 
@@ -48,8 +51,18 @@ SysCallBase sys_time("sys_time");
 
 static const u64 g_timebase_freq = /*79800000*/ 80000000; // 80 Mhz
 
-// Auxiliary functions
-u64 get_timebased_time()
+// Guest clock state, set by init_guest_clock() before the emulation starts
+// (guest time = guest base + (host time - host base) * scale / 100 + skipped time)
+static u64 g_clock_host_base = 0;
+static u64 g_clock_guest_base = 0;
+static u64 g_clock_tb_host_base = 0;
+static u64 g_clock_tb_guest_base = 0;
+static u32 g_clock_scale = 100; // guest clock speed in percent of the real time
+static bool g_clock_skip_idle = false;
+static atomic_t<u64> g_clock_skipped{ 0 }; // time skipped while all threads were idle (in microseconds)
+
+// Host timebase (80 MHz) time
+static u64 get_host_timebased_time()
 {
 #ifdef _WIN32
 	LARGE_INTEGER count;
@@ -73,8 +86,8 @@ u64 get_timebased_time()
 #endif
 }
 
-// Returns some relative time in microseconds, don't change this fact
-u64 get_system_time()
+// Host monotonic time in microseconds
+static u64 get_host_system_time()
 {
 	while (true)
 	{
@@ -103,6 +116,78 @@ u64 get_system_time()
 	}
 }
 
+// Auxiliary functions
+u64 get_timebased_time()
+{
+	const u64 time = get_host_timebased_time() - g_clock_tb_host_base;
+
+	return g_clock_tb_guest_base + (g_clock_scale == 100 ? time : time * g_clock_scale / 100) + g_clock_skipped.load() * (g_timebase_freq / 1000000);
+}
+
+// Returns some relative time in microseconds, don't change this fact
+u64 get_system_time()
+{
+	const u64 time = get_host_system_time() - g_clock_host_base;
+
+	return g_clock_guest_base + (g_clock_scale == 100 ? time : time * g_clock_scale / 100) + g_clock_skipped.load();
+}
+
+// Convert guest time interval (in microseconds) to the host time interval
+u64 get_host_wait_time(u64 time)
+{
+	return g_clock_scale == 100 ? time : time * 100 / g_clock_scale;
+}
+
+// Advance the guest clock if all CPU threads are waiting (only if enabled)
+bool skip_guest_time(u64 time)
+{
+	if (!g_clock_skip_idle || !time)
+	{
+		return false;
+	}
+
+	const auto threads = CPUThreadManager::GetAllThreads();
+
+	for (auto& t : threads)
+	{
+		if (!t->is_stopped() && !t->is_sleeping())
+		{
+			return false;
+		}
+	}
+
+	g_clock_skipped += time;
+
+	// wake up threads waiting with timeout, so they can check the new time
+	for (auto& t : threads)
+	{
+		std::lock_guard<std::mutex> lock(t->mutex);
+
+		t->cv.notify_one();
+	}
+
+	return true;
+}
+
+// Reset the guest clock (called before the emulation starts)
+void init_guest_clock()
+{
+	// continue from the current guest time, so it never goes backwards
+	g_clock_guest_base = get_system_time();
+	g_clock_tb_guest_base = get_timebased_time();
+	g_clock_host_base = get_host_system_time();
+	g_clock_tb_host_base = get_host_timebased_time();
+	g_clock_skipped = 0;
+
+	g_clock_scale = std::max<u32>(rpcs3::state.config.core.clock_scale.value(), 1);
+	g_clock_skip_idle = rpcs3::state.config.core.clock_skip_idle.value();
+
+	if (g_clock_scale != 100 || g_clock_skip_idle)
+	{
+		LOG_NOTICE(GENERAL, "Guest clock: scale=%u%%, skip idle time=%s", g_clock_scale, g_clock_skip_idle ? "on" : "off");
+	}
+}
+
 // Functions
 s32 sys_time_get_timezone(vm::ptr<s32> timezone, vm::ptr<s32> summertime)
 {
@@ -118,6 +203,9 @@ s32 sys_time_get_current_time(vm::ptr<s64> sec, vm::ptr<s64> nsec)
 {
 	sys_time.trace("sys_time_get_current_time(sec=*0x%x, nsec=*0x%x)", sec, nsec);
 
+	// difference between the guest and host clocks in nanoseconds (may be negative)
+	const u64 drift = (get_system_time() - get_host_system_time()) * 1000u;
+
 #ifdef _WIN32
 	LARGE_INTEGER count;
 	if (!QueryPerformanceCounter(&count))
@@ -128,8 +216,8 @@ s32 sys_time_get_current_time(vm::ptr<s64> sec, vm::ptr<s64> nsec)
 	// get time difference in nanoseconds
 	const u64 diff = (count.QuadPart - g_time_aux_info.start_time) * 1000000000u / g_time_aux_info.perf_freq;
 
-	// get time since Epoch in nanoseconds
-	const u64 time = g_time_aux_info.start_ftime * 100u + diff;
+	// get time since Epoch in nanoseconds (adjusted by the guest clock drift)
+	const u64 time = g_time_aux_info.start_ftime * 100u + diff + drift;
 
 	*sec = time / 1000000000u;
 	*nsec = time % 1000000000u;
@@ -140,8 +228,10 @@ s32 sys_time_get_current_time(vm::ptr<s64> sec, vm::ptr<s64> nsec)
 		throw EXCEPTION("System error %d", errno);
 	}
 
-	*sec = ts.tv_sec;
-	*nsec = ts.tv_nsec;
+	const u64 time = static_cast<u64>(ts.tv_sec) * 1000000000u + static_cast<u64>(ts.tv_nsec) + drift;
+
+	*sec = time / 1000000000u;
+	*nsec = time % 1000000000u;
 #endif
 
 	return CELL_OK;
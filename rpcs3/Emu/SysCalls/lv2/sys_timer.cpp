@@ -4,7 +4,8 @@
 #include "Emu/IdManager.h"
 #include "Emu/SysCalls/SysCalls.h"
 
-#include "Utilities/Thread.h"
+#include "Emu/TimerService.h"
+#include "Emu/Cell/PPUThread.h"
 #include "sys_event.h"
 #include "sys_process.h"
 #include "sys_timer.h"
@@ -13,57 +14,26 @@ SysCallBase sys_timer("sys_timer");
 
 extern u64 get_system_time();
 
-void lv2_timer_t::on_task()
+lv2_timer_t::lv2_timer_t()
+	: id(idm::get_last_id())
 {
-	std::unique_lock<std::mutex> lock(mutex);
+}
 
-	while (state <= SYS_TIMER_STATE_RUN)
-	{
-		CHECK_EMU_STATUS;
+void lv2_timer_t::stop(lv2_lock_t& lv2_lock)
+{
+	CHECK_LV2_LOCK(lv2_lock);
 
-		if (state == SYS_TIMER_STATE_RUN)
-		{
-			if (lock) lock.unlock();
-
-			LV2_LOCK;
-
-			if (get_system_time() >= expire)
-			{
-				const auto queue = port.lock();
-
-				if (queue)
-				{
-					queue->push(lv2_lock, source, data1, data2, expire);
-				}
-
-				if (period && queue)
-				{
-					expire += period; // set next expiration time
-
-					continue; // hack: check again
-				}
-				else
-				{
-					state = SYS_TIMER_STATE_STOP; // stop if oneshot or the event port was disconnected (TODO: is it correct?)
-				}
-			}
-		}
+	state = SYS_TIMER_STATE_STOP;
 
-		if (!lock)
-		{
-			lock.lock();
-			continue;
-		}
+	if (service_id)
+	{
+		// the callback may be already called, it will be ignored
+		fxm::get_always<timer_service_t>()->remove(service_id);
 
-		cv.wait_for(lock, std::chrono::milliseconds(1));
+		service_id = 0;
 	}
 }
 
-lv2_timer_t::lv2_timer_t()
-	: id(idm::get_last_id())
-{
-}
-
 s32 sys_timer_create(vm::ptr<u32> timer_id)
 {
 	sys_timer.warning("sys_timer_create(timer_id=*0x%x)", timer_id);
@@ -91,6 +61,8 @@ s32 sys_timer_destroy(u32 timer_id)
 		return CELL_EISCONN;
 	}
 
+	timer->stop(lv2_lock);
+
 	idm::remove<lv2_timer_t>(timer_id);
 
 	return CELL_OK;
@@ -162,15 +134,42 @@ s32 _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 	}
 
 	// sys_timer_start_periodic() will use current time (TODO: is it correct?)
-
-	// lock for reliable notification
-	std::lock_guard<std::mutex> lock(timer->mutex);
-
 	timer->expire = base_time ? base_time : start_time + period;
 	timer->period = period;
 	timer->state  = SYS_TIMER_STATE_RUN;
 
-	timer->cv.notify_one();
+	const u32 start_count = ++timer->start_count;
+
+	timer->service_id = fxm::get_always<timer_service_t>()->add(timer->expire, [ptr = std::weak_ptr<lv2_timer_t>(timer), start_count](u64 now) -> u64
+	{
+		LV2_LOCK;
+
+		const auto timer = ptr.lock();
+
+		if (!timer || timer->start_count != start_count || timer->state != SYS_TIMER_STATE_RUN)
+		{
+			return 0;
+		}
+
+		const auto queue = timer->port.lock();
+
+		if (queue)
+		{
+			queue->push(timer->source, timer->data1, timer->data2, timer->expire);
+		}
+
+		if (timer->period && queue)
+		{
+			// set next expiration time (called again immediately if it has already passed)
+			return timer->expire += timer->period;
+		}
+
+		// stop if oneshot or the event port was disconnected (TODO: is it correct?)
+		timer->state = SYS_TIMER_STATE_STOP;
+		timer->service_id = 0;
+
+		return 0;
+	});
 
 	return CELL_OK;
 }
@@ -188,7 +187,7 @@ s32 sys_timer_stop(u32 timer_id)
 		return CELL_ESRCH;
 	}
 
-	timer->state = SYS_TIMER_STATE_STOP; // stop timer
+	timer->stop(lv2_lock); // stop timer
 
 	return CELL_OK;
 }
@@ -239,55 +238,36 @@ s32 sys_timer_disconnect_event_queue(u32 timer_id)
 	}
 
 	timer->port.reset(); // disconnect event queue
-	timer->state = SYS_TIMER_STATE_STOP; // stop timer
+	timer->stop(lv2_lock); // stop timer
 
 	return CELL_OK;
 }
 
-s32 sys_timer_sleep(u32 sleep_time)
+s32 sys_timer_sleep(PPUThread& ppu, u32 sleep_time)
 {
 	sys_timer.trace("sys_timer_sleep(sleep_time=%d)", sleep_time);
 
-	const u64 start_time = get_system_time();
-
-	const u64 useconds = sleep_time * 1000000ull;
-
-	u64 passed;
-
-	while (useconds > (passed = get_system_time() - start_time) + 1000)
-	{
-		CHECK_EMU_STATUS;
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
-	
-	if (useconds > passed)
-	{
-		std::this_thread::sleep_for(std::chrono::microseconds(useconds - passed));
-	}
-
-	return CELL_OK;
+	return sys_timer_usleep(ppu, sleep_time * 1000000ull);
 }
 
-s32 sys_timer_usleep(u64 sleep_time)
+s32 sys_timer_usleep(PPUThread& ppu, u64 sleep_time)
 {
 	sys_timer.trace("sys_timer_usleep(sleep_time=0x%llx)", sleep_time);
 
 	const u64 start_time = get_system_time();
 
-	u64 passed;
+	const auto timers = fxm::get_always<timer_service_t>();
 
-	while (sleep_time > (passed = get_system_time() - start_time) + 1000)
-	{
-		CHECK_EMU_STATUS;
+	std::unique_lock<std::mutex> lock(ppu.mutex);
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
+	// mark the thread as waiting (the guest clock may skip idle time)
+	ppu.sleep();
 
-	if (sleep_time > passed)
-	{
-		std::this_thread::sleep_for(std::chrono::microseconds(sleep_time - passed));
-	}
+	timers->wait_until(start_time + sleep_time, lock, ppu.cv);
+
+	ppu.awake();
+
+	CHECK_EMU_STATUS;
 
 	return CELL_OK;
 }
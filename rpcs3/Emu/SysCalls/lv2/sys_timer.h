@@ -1,7 +1,5 @@
 #pragma once
 
-#include "Utilities/Thread.h"
-
 namespace vm { using namespace ps3; }
 
 // Timer State
@@ -19,24 +17,10 @@ struct sys_timer_information_t
 	be_t<u32> pad;
 };
 
-class lv2_timer_t final : public named_thread_t
+struct lv2_timer_t final
 {
-	void on_task() override;
-
-	void on_id_aux_finalize() override
-	{
-		// Signal thread using invalid state and join
-		{ std::lock_guard<std::mutex>{mutex}, state = -1; }
-
-		cv.notify_one();
-		join();
-	}
-
-public:
 	lv2_timer_t();
 
-	std::string get_name() const override { return fmt::format("Timer Thread[0x%x]", id); }
-
 	const u32 id;
 
 	std::weak_ptr<lv2_event_queue_t> port; // event queue
@@ -47,9 +31,18 @@ public:
 	u64 expire = 0; // next expiration time
 	u64 period = 0; // period (oneshot if 0)
 
-	std::atomic<u32> state{ SYS_TIMER_STATE_RUN }; // timer state
+	std::atomic<u32> state{ SYS_TIMER_STATE_STOP }; // timer state
+
+	u32 service_id = 0; // timer service registration
+	u32 start_count = 0; // incremented on every start (outdated registrations are ignored)
+
+	// Stop and unregister from the timer service
+	void stop(lv2_lock_t& lv2_lock);
 };
 
+class PPUThread;
+
+// SysCalls
 s32 sys_timer_create(vm::ptr<u32> timer_id);
 s32 sys_timer_destroy(u32 timer_id);
 s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> info);
@@ -57,5 +50,5 @@ s32 _sys_timer_start(u32 timer_id, u64 basetime, u64 period); // basetime type c
 s32 sys_timer_stop(u32 timer_id);
 s32 sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u64 data1, u64 data2);
 s32 sys_timer_disconnect_event_queue(u32 timer_id);
-s32 sys_timer_sleep(u32 sleep_time);
-s32 sys_timer_usleep(u64 sleep_time);
+s32 sys_timer_sleep(PPUThread& ppu, u32 sleep_time);
+s32 sys_timer_usleep(PPUThread& ppu, u64 sleep_time);
@@ -11,6 +11,7 @@
 #include "Emu/SysCalls/ModuleManager.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/SPURecompiler.h"
 #include "Emu/Cell/PPUInstrTable.h"
 #include "Emu/FS/vfsFile.h"
 #include "Emu/FS/vfsLocalFile.h"
@@ -61,6 +62,7 @@ struct bpdb_header_t
 extern std::atomic<u32> g_thread_count;
 
 extern u64 get_system_time();
+extern void init_guest_clock();
 extern void finalize_psv_modules();
 
 Emulator::Emulator()
@@ -287,6 +289,20 @@ void Emulator::Load()
 	
 	LoadPoints(fs::get_config_dir() + BreakPointsDBName);
 
+	if (rpcs3::state.config.core.spu_decoder.value() == spu_decoder_type::recompiler_asmjit)
+	{
+		// Compile SPU functions cached in the previous sessions before they are used
+		const auto queue = fxm::get_always<spu_compile_queue_t>();
+		const auto loaded = fxm::get_always<SPUDatabase>()->get_loaded();
+
+		for (auto& func : loaded)
+		{
+			queue->push(func);
+		}
+
+		LOG_NOTICE(SPU, "SPU cache: %u functions loaded", size32(loaded));
+	}
+
 	GetGSManager().Init();
 	GetCallbackManager().Init();
 	GetAudioManager().Init();
@@ -319,6 +335,8 @@ void Emulator::Run()
 	m_pause_amend_time = 0;
 	m_status = Running;
 
+	init_guest_clock();
+
 	GetCPU().Exec();
 	SendDbgCommand(DID_STARTED_EMU);
 }
@@ -422,6 +440,14 @@ void Emulator::Stop()
 		m_cb.process_events();
 
 		std::this_thread::sleep_for(10ms);
+
+		// threads waiting on lv2 objects with per-object locks could have missed the notification
+		for (auto& t : GetCPU().GetAllThreads())
+		{
+			std::lock_guard<std::mutex> lock(t->mutex);
+
+			t->cv.notify_one();
+		}
 	}
 
 	LOG_NOTICE(GENERAL, "All threads stopped...");
@@ -270,4 +270,5 @@ inline bool check_lv2_lock(lv2_lock_t& lv2_lock)
 #define LV2_LOCK lv2_lock_t lv2_lock(Emu.GetCoreMutex())
 #define LV2_DEFER_LOCK lv2_lock_t lv2_lock
 #define CHECK_LV2_LOCK(x) if (!check_lv2_lock(x)) throw EXCEPTION("lv2_lock is invalid or not locked")
+#define CHECK_LV2_OBJECT_LOCK(x, obj) if (!(x).owns_lock() || (x).mutex() != &(obj).lock) throw EXCEPTION("lv2_lock is invalid or not locked")
 #define CHECK_EMU_STATUS if (Emu.IsStopped()) throw EmulationStopped{}
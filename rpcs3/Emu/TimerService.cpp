@@ -0,0 +1,214 @@
+#include "stdafx.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+
+#include "TimerService.h"
+
+extern u64 get_system_time();
+extern u64 get_host_wait_time(u64 time);
+extern bool skip_guest_time(u64 time);
+
+// Remaining time (in microseconds) spent spinning instead of sleeping, depends on the OS sleep precision
+#ifdef _WIN32
+const u64 g_timer_spin_time = 1000;
+#else
+const u64 g_timer_spin_time = 100;
+#endif
+
+// Max sleep time without timers (in microseconds), the thread must notice that emulation is stopped
+const u64 g_timer_idle_time = 20000;
+
+void timer_service_t::on_task()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!m_stop && !Emu.IsStopped())
+	{
+		const u64 now = get_system_time();
+
+		if (m_queue.empty() || m_queue.begin()->first > now)
+		{
+			const u64 left = m_queue.empty() ? g_timer_idle_time : std::min(m_queue.begin()->first - now, g_timer_idle_time);
+
+			if (!m_queue.empty())
+			{
+				// (lock order: thread mutexes are locked before the service mutex)
+				lock.unlock();
+				const bool skipped = skip_guest_time(left);
+				lock.lock();
+
+				if (skipped)
+				{
+					continue;
+				}
+			}
+
+			if (left > g_timer_spin_time)
+			{
+				cv.wait_for(lock, std::chrono::microseconds(get_host_wait_time(left - g_timer_spin_time)));
+			}
+			else
+			{
+				// allow adding timers while spinning
+				lock.unlock();
+				std::this_thread::yield();
+				lock.lock();
+			}
+
+			continue;
+		}
+
+		const u32 id = m_queue.begin()->second;
+
+		m_queue.erase(m_queue.begin());
+
+		auto& timer = m_timers.at(id);
+
+		const u64 late = now - timer.first;
+
+		m_late_count++;
+		m_late_sum += late;
+		m_late_max = std::max(m_late_max, late);
+		m_late_hist[late < 10 ? 0 : late < 50 ? 1 : late < 100 ? 2 : late < 500 ? 3 : late < 1000 ? 4 : 5]++;
+
+		// the callback is moved out because the timer can be removed while it's called
+		timer_func_t func = std::move(timer.second);
+
+		m_running = id;
+
+		lock.unlock();
+
+		const u64 next = func(now);
+
+		lock.lock();
+
+		m_running = 0;
+		m_running_cv.notify_all();
+
+		const auto found = m_timers.find(id);
+
+		if (found == m_timers.end())
+		{
+			continue;
+		}
+
+		if (next)
+		{
+			found->second.first = next;
+			found->second.second = std::move(func);
+			m_queue.emplace(next, id);
+		}
+		else
+		{
+			m_timers.erase(found);
+		}
+	}
+
+	lock.unlock();
+
+	if (m_late_count)
+	{
+		LOG_NOTICE(GENERAL, "Timer Service: %s", get_late_stats());
+	}
+}
+
+void timer_service_t::on_id_aux_finalize()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		m_stop = true;
+
+		cv.notify_one();
+	}
+
+	join();
+}
+
+u32 timer_service_t::add(u64 time, timer_func_t func)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// skip zero id on overflow
+	const u32 id = ++m_last_id ? m_last_id : ++m_last_id;
+
+	// wake up the thread if the timer is the nearest one
+	if (m_queue.empty() || time < m_queue.begin()->first)
+	{
+		cv.notify_one();
+	}
+
+	m_timers.emplace(id, std::make_pair(time, std::move(func)));
+	m_queue.emplace(time, id);
+
+	return id;
+}
+
+bool timer_service_t::remove(u32 id, bool wait)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	const auto found = m_timers.find(id);
+
+	if (found == m_timers.end())
+	{
+		return false;
+	}
+
+	// not queued if the callback is being called
+	m_queue.erase(std::make_pair(found->second.first, id));
+	m_timers.erase(found);
+
+	while (wait && m_running == id && !is_current())
+	{
+		m_running_cv.wait(lock);
+	}
+
+	return true;
+}
+
+void timer_service_t::wait_until(u64 time, std::unique_lock<std::mutex>& lock, std::condition_variable& cv)
+{
+	const auto mutex = lock.mutex();
+
+	const u32 id = add(time, [mutex, &cv](u64) -> u64
+	{
+		// lock for reliable notification
+		std::lock_guard<std::mutex> lock(*mutex);
+
+		cv.notify_one();
+
+		return 0;
+	});
+
+	while (get_system_time() < time && !Emu.IsStopped())
+	{
+		// the timer service may be already stopped
+		cv.wait_for(lock, std::chrono::microseconds(g_timer_idle_time));
+	}
+
+	// the callback must not outlive cv
+	lock.unlock();
+	remove(id, true);
+	lock.lock();
+}
+
+std::string timer_service_t::get_late_stats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return fmt::format("%llu expirations, lateness avg=%lluus max=%lluus (<10us: %llu, <50us: %llu, <100us: %llu, <500us: %llu, <1ms: %llu, >=1ms: %llu)",
+		m_late_count, m_late_count ? m_late_sum / m_late_count : 0, m_late_max, m_late_hist[0], m_late_hist[1], m_late_hist[2], m_late_hist[3], m_late_hist[4], m_late_hist[5]);
+}
+
+scope_timer_t::scope_timer_t(u64 time, timer_func_t func, bool wait)
+	: m_service(fxm::get_always<timer_service_t>())
+	, m_id(m_service->add(time, std::move(func)))
+	, m_wait(wait)
+{
+}
+
+scope_timer_t::~scope_timer_t()
+{
+	m_service->remove(m_id, m_wait);
+}
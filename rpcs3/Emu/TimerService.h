@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Utilities/Thread.h"
+
+// Timer callback (called with the current time, returns the next expiration time or 0 to remove the timer)
+using timer_func_t = std::function<u64(u64 now)>;
+
+// Central thread serving lv2 timers, timed waits and periodic emulator tasks.
+// Expiration times are absolute (get_system_time() base), the thread sleeps until the nearest one and spins the rest.
+// If the guest clock skips idle time, it's advanced to the nearest expiration time when all CPU threads are waiting.
+class timer_service_t final : public named_thread_t
+{
+	// (expiration time, timer id)
+	std::set<std::pair<u64, u32>> m_queue;
+
+	// timer id -> (expiration time, callback)
+	std::unordered_map<u32, std::pair<u64, timer_func_t>> m_timers;
+
+	u32 m_last_id = 0;
+
+	// timer id of the callback being called
+	u32 m_running = 0;
+
+	std::condition_variable m_running_cv;
+
+	atomic_t<bool> m_stop{ false };
+
+	// Expiration lateness statistics
+	u64 m_late_count = 0;
+	u64 m_late_sum = 0;
+	u64 m_late_max = 0;
+	std::array<u64, 6> m_late_hist{}; // < 10 us, < 50 us, < 100 us, < 500 us, < 1 ms, >= 1 ms
+
+	void on_task() override;
+	void on_id_aux_finalize() override;
+
+public:
+	std::string get_name() const override { return "Timer Service"; }
+
+	// Register a timer (returns timer id)
+	u32 add(u64 time, timer_func_t func);
+
+	// Unregister a timer (returns false if not found); if wait is set, also wait for the callback being called
+	// (don't set it while holding a lock the callback may need)
+	bool remove(u32 id, bool wait = false);
+
+	// Wait until the specified time on cv (the thread is notified with the mutex of the lock acquired)
+	void wait_until(u64 time, std::unique_lock<std::mutex>& lock, std::condition_variable& cv);
+
+	// Get expiration lateness statistics as a string
+	std::string get_late_stats();
+};
+
+// Timer registration which is removed automatically, can only be used in function scope
+class scope_timer_t final
+{
+	const std::shared_ptr<timer_service_t> m_service;
+	const u32 m_id;
+	const bool m_wait;
+
+public:
+	// Set wait if the callback references objects of the scope
+	scope_timer_t(u64 time, timer_func_t func, bool wait = false);
+
+	scope_timer_t(const scope_timer_t&) = delete;
+
+	~scope_timer_t();
+};
@@ -5,6 +5,7 @@
 #include "rpcs3.h"
 #include "InterpreterDisAsm.h"
 #include "Emu/CPU/CPUThreadManager.h"
+#include "Emu/CPU/CPUProfiler.h"
 #include "Emu/Cell/PPUDecoder.h"
 #include "Emu/Cell/PPUDisAsm.h"
 #include "Emu/Cell/SPUDisAsm.h"
@@ -40,12 +41,14 @@ InterpreterDisAsmFrame::InterpreterDisAsmFrame(wxWindow* parent)
 	m_btn_step  = new wxButton(this, wxID_ANY, "Step");
 	m_btn_run   = new wxButton(this, wxID_ANY, "Run");
 	m_btn_pause = new wxButton(this, wxID_ANY, "Pause");
+	m_btn_profile = new wxButton(this, wxID_ANY, cpu_profiler_is_running() ? "Stop Profiler" : "Profile");
 
 	s_b_main->Add(b_go_to_addr,   wxSizerFlags().Border(wxALL, 5));
 	s_b_main->Add(b_go_to_pc,     wxSizerFlags().Border(wxALL, 5));
 	s_b_main->Add(m_btn_step,     wxSizerFlags().Border(wxALL, 5));
 	s_b_main->Add(m_btn_run,      wxSizerFlags().Border(wxALL, 5));
 	s_b_main->Add(m_btn_pause,    wxSizerFlags().Border(wxALL, 5));
+	s_b_main->Add(m_btn_profile,  wxSizerFlags().Border(wxALL, 5));
 	s_b_main->Add(m_choice_units, wxSizerFlags().Border(wxALL, 5));
 
 	//Registers
@@ -85,6 +88,7 @@ InterpreterDisAsmFrame::InterpreterDisAsmFrame(wxWindow* parent)
 	m_btn_step    ->Bind(wxEVT_BUTTON,              &InterpreterDisAsmFrame::DoStep, this);
 	m_btn_run     ->Bind(wxEVT_BUTTON,              &InterpreterDisAsmFrame::DoRun, this);
 	m_btn_pause   ->Bind(wxEVT_BUTTON,              &InterpreterDisAsmFrame::DoPause, this);
+	m_btn_profile ->Bind(wxEVT_BUTTON,              &InterpreterDisAsmFrame::DoProfile, this);
 	m_list        ->Bind(wxEVT_LIST_KEY_DOWN,       &InterpreterDisAsmFrame::InstrKey, this);
 	m_list        ->Bind(wxEVT_LIST_ITEM_ACTIVATED, &InterpreterDisAsmFrame::DClick, this);
 	m_list        ->Bind(wxEVT_MOUSEWHEEL,          &InterpreterDisAsmFrame::MouseWheel, this);
@@ -370,6 +374,7 @@ void InterpreterDisAsmFrame::HandleCommand(wxCommandEvent& event)
 		{
 		case DID_STOPPED_EMU:
 			UpdateUnitList();
+			m_btn_profile->SetLabel("Profile");
 		break;
 
 		case DID_PAUSED_EMU:
@@ -509,6 +514,20 @@ void InterpreterDisAsmFrame::DoStep(wxCommandEvent& WXUNUSED(event))
 	if(CPU) CPU->step();
 }
 
+void InterpreterDisAsmFrame::DoProfile(wxCommandEvent& WXUNUSED(event))
+{
+	if (cpu_profiler_is_running())
+	{
+		cpu_profiler_stop();
+	}
+	else
+	{
+		cpu_profiler_start(fs::get_config_dir() + "profile.folded");
+	}
+
+	m_btn_profile->SetLabel(cpu_profiler_is_running() ? "Stop Profiler" : "Profile");
+}
+
 void InterpreterDisAsmFrame::InstrKey(wxListEvent& event)
 {
 	long i = m_list->GetFirstSelected();
@@ -15,6 +15,7 @@ class InterpreterDisAsmFrame : public wxPanel
 	wxButton* m_btn_step;
 	wxButton* m_btn_run;
 	wxButton* m_btn_pause;
+	wxButton* m_btn_profile;
 	u32 m_item_count;
 	wxChoice* m_choice_units;
 
@@ -43,6 +44,7 @@ public:
 	void DoRun(wxCommandEvent& event);
 	void DoPause(wxCommandEvent& event);
 	void DoStep(wxCommandEvent& event);
+	void DoProfile(wxCommandEvent& event);
 	void InstrKey(wxListEvent& event);
 	void DClick(wxListEvent& event);
 
@@ -132,6 +132,8 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	wxStaticBoxSizer* s_round_llvm = new wxStaticBoxSizer(wxVERTICAL, p_core, _("LLVM config"));
 	wxStaticBoxSizer* s_round_llvm_range = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("Excluded block range"));
 	wxStaticBoxSizer* s_round_llvm_threshold = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("Compilation threshold"));
+	wxStaticBoxSizer* s_round_spu_workers = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("SPU worker threads (0 = unlimited)"));
+	wxStaticBoxSizer* s_round_clock_scale = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("Guest clock speed (%)"));
 
 	// Graphics
 	wxStaticBoxSizer* s_round_gs_render = new wxStaticBoxSizer(wxVERTICAL, p_graphics, _("Render"));
@@ -180,8 +182,10 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	wxComboBox* cbox_sys_lang = new wxComboBox(p_system, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, 0, NULL, wxCB_READONLY);
 
 	wxCheckBox* chbox_core_llvm_exclud = new wxCheckBox(p_core, wxID_ANY, "Compiled blocks exclusion");
+	wxCheckBox* chbox_core_llvm_aot = new wxCheckBox(p_core, wxID_ANY, "Ahead-of-time compilation");
 	wxCheckBox* chbox_core_hook_stfunc = new wxCheckBox(p_core, wxID_ANY, "Hook static functions");
 	wxCheckBox* chbox_core_load_liblv2 = new wxCheckBox(p_core, wxID_ANY, "Load liblv2.sprx");
+	wxCheckBox* chbox_core_clock_skip_idle = new wxCheckBox(p_core, wxID_ANY, "Skip idle time");
 	wxCheckBox* chbox_gs_log_prog = new wxCheckBox(p_graphics, wxID_ANY, "Log shader programs");
 	wxCheckBox* chbox_gs_dump_depth = new wxCheckBox(p_graphics, wxID_ANY, "Write Depth Buffer");
 	wxCheckBox* chbox_gs_dump_color = new wxCheckBox(p_graphics, wxID_ANY, "Write Color Buffers");
@@ -201,6 +205,8 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	wxTextCtrl* txt_dbg_range_min = new wxTextCtrl(p_core, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(55, 20));
 	wxTextCtrl* txt_dbg_range_max = new wxTextCtrl(p_core, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(55, 20));
 	wxTextCtrl* txt_llvm_threshold = new wxTextCtrl(p_core, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(55, 20));
+	wxTextCtrl* txt_spu_workers = new wxTextCtrl(p_core, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(55, 20));
+	wxTextCtrl* txt_clock_scale = new wxTextCtrl(p_core, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(55, 20));
 
 	//Auto Pause
 	wxCheckBox* chbox_dbg_ap_systemcall = new wxCheckBox(p_misc, wxID_ANY, "Auto Pause at System Call");
@@ -322,6 +328,7 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 		cbox_sys_lang->Append(lang);
 
 	chbox_core_llvm_exclud->SetValue(cfg->core.llvm.exclusion_range.value());
+	chbox_core_llvm_aot->SetValue(cfg->core.llvm.aot.value());
 	chbox_gs_log_prog->SetValue(rpcs3::config.rsx.log_programs.value());
 	chbox_gs_dump_depth->SetValue(cfg->rsx.opengl.write_depth_buffer.value());
 	chbox_gs_dump_color->SetValue(cfg->rsx.opengl.write_color_buffers.value());
@@ -339,6 +346,7 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	chbox_hle_use_default_ini->SetValue(rpcs3::config.misc.use_default_ini.value());
 	chbox_core_hook_stfunc->SetValue(cfg->core.hook_st_func.value());
 	chbox_core_load_liblv2->SetValue(cfg->core.load_liblv2.value());
+	chbox_core_clock_skip_idle->SetValue(cfg->core.clock_skip_idle.value());
 
 	//Auto Pause related
 	chbox_dbg_ap_systemcall->SetValue(rpcs3::config.misc.debug.auto_pause_syscall.value());
@@ -353,6 +361,8 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	txt_dbg_range_max->SetValue(cfg->core.llvm.max_id.string_value());
 	txt_llvm_threshold->SetValue(cfg->core.llvm.threshold.string_value());
 	rbox_spu_decoder->SetSelection((int)cfg->core.spu_decoder.value());
+	txt_spu_workers->SetValue(cfg->core.spu_workers.string_value());
+	txt_clock_scale->SetValue(cfg->core.clock_scale.string_value());
 	cbox_gs_render->SetSelection((int)cfg->rsx.renderer.value());
 	cbox_gs_d3d_adaptater->SetSelection(cfg->rsx.d3d12.adaptater.value());
 	cbox_gs_resolution->SetSelection(ResolutionIdToNum((int)cfg->rsx.resolution.value()) - 1);
@@ -376,6 +386,7 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	s_round_llvm->Add(s_round_llvm_range, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_llvm_threshold->Add(txt_llvm_threshold, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_llvm->Add(s_round_llvm_threshold, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_llvm->Add(chbox_core_llvm_aot, wxSizerFlags().Border(wxALL, 5).Expand());
 
 	// Rendering
 	s_round_gs_render->Add(cbox_gs_render, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -405,6 +416,11 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	// Core
 	s_subpanel_core1->Add(rbox_ppu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core2->Add(rbox_spu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_spu_workers->Add(txt_spu_workers, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core2->Add(s_round_spu_workers, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_clock_scale->Add(txt_clock_scale, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core2->Add(s_round_clock_scale, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core2->Add(chbox_core_clock_skip_idle, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core1->Add(s_round_llvm, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core1->Add(chbox_core_hook_stfunc, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core1->Add(chbox_core_load_liblv2, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -487,9 +503,13 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 	{
 		long llvmthreshold;
 		long minllvmid, maxllvmid;
+		long spuworkers;
+		long clockscale;
 		txt_dbg_range_min->GetValue().ToLong(&minllvmid);
 		txt_dbg_range_max->GetValue().ToLong(&maxllvmid);
 		txt_llvm_threshold->GetValue().ToLong(&llvmthreshold);
+		txt_spu_workers->GetValue().ToLong(&spuworkers);
+		txt_clock_scale->GetValue().ToLong(&clockscale);
 
 		// individual settings
 		cfg->core.ppu_decoder = rbox_ppu_decoder->GetSelection();
@@ -497,7 +517,11 @@ SettingsDialog::SettingsDialog(wxWindow *parent, rpcs3::config_t* cfg)
 		cfg->core.llvm.min_id = minllvmid;
 		cfg->core.llvm.max_id = maxllvmid;
 		cfg->core.llvm.threshold = llvmthreshold;
+		cfg->core.llvm.aot = chbox_core_llvm_aot->GetValue();
 		cfg->core.spu_decoder = rbox_spu_decoder->GetSelection();
+		cfg->core.spu_workers = spuworkers;
+		cfg->core.clock_scale = clockscale;
+		cfg->core.clock_skip_idle = chbox_core_clock_skip_idle->GetValue();
 		cfg->core.hook_st_func = chbox_core_hook_stfunc->GetValue();
 		cfg->core.load_liblv2 = chbox_core_load_liblv2->GetValue();
 
@@ -11,6 +11,7 @@
 #include "Emu/SysCalls/ModuleManager.h"
 #include "Emu/SysCalls/lv2/sys_prx.h"
 #include "Emu/Cell/PPUInstrTable.h"
+#include "Emu/CPU/CPUProfiler.h"
 #include "ELF64.h"
 
 using namespace PPU_instr;
@@ -103,6 +104,7 @@ namespace loader
 						sprx_segment_info segment;
 						segment.size = phdr.p_memsz;
 						segment.size_file = phdr.p_filesz;
+						segment.flags = phdr.p_flags;
 
 						segment.begin.set(vm::alloc(segment.size, vm::main));
 
@@ -320,6 +322,9 @@ namespace loader
 			std::vector<u32> stop_funcs;
 			std::vector<u32> exit_funcs;
 
+			// executable areas of LLE libraries (addr, size)
+			std::vector<std::pair<u32, u32>> lle_code;
+
 			//load modules
 			vfsDir lle_dir("/dev_flash/sys/external");
 			
@@ -361,6 +366,14 @@ namespace loader
 						sprx_info info;
 						sprx_handler.load_sprx(info);
 
+						for (auto& seg : info.segments)
+						{
+							if (seg.flags & 0x1)
+							{
+								lle_code.emplace_back(seg.begin.addr(), seg.size);
+							}
+						}
+
 						for (auto &m : info.modules)
 						{
 							if (m.first == "")
@@ -427,6 +440,11 @@ namespace loader
 								const u32 nid = f.first;
 								const u32 addr = f.second;
 
+								if (vm::check_addr(addr, 8))
+								{
+									cpu_profiler_add_symbol(vm::read32(addr), get_ps3_function_name(nid));
+								}
+
 								u32 index;
 
 								auto func = get_ppu_func_by_nid(nid, &index);
@@ -565,6 +583,21 @@ namespace loader
 				}
 			}
 
+			extern void ppu_precompile(u32 addr, u32 size, bool async);
+
+			for (auto &phdr : m_phdrs)
+			{
+				if (phdr.p_type == 0x00000001 && phdr.p_filesz && (phdr.p_flags & 0x1))
+				{
+					ppu_precompile(phdr.p_vaddr.addr(), phdr.p_filesz, false);
+				}
+			}
+
+			for (auto &code : lle_code)
+			{
+				ppu_precompile(code.first, code.second, false);
+			}
+
 			ppu_thread main_thread(OPD.addr(), "main_thread");
 
 			main_thread.args({ Emu.GetPath()/*, "-emu"*/ }).run();
@@ -682,6 +715,9 @@ namespace loader
 							break;
 						}
 
+						const auto import_start = std::chrono::high_resolution_clock::now();
+						u32 import_count = 0;
+
 						for (auto stub = proc_prx_param.libstubstart; stub < proc_prx_param.libstubend; ++stub)
 						{
 							const std::string module_name = stub->s_modulename.get_ptr();
@@ -719,8 +755,14 @@ namespace loader
 								{
 									LOG_ERROR(LOADER, "Failed to inject code at address 0x%x", addr);
 								}
+
+								import_count++;
 							}
 						}
+
+						const auto import_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - import_start);
+
+						LOG_NOTICE(LOADER, "%u imports resolved in %lld us", import_count, import_time.count());
 					}
 					break;
 				}
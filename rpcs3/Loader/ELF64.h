@@ -123,6 +123,7 @@ namespace loader
 				_ptr_base<void> begin;
 				u32 size;
 				u32 size_file;
+				u32 flags;
 				_ptr_base<void> initial_addr;
 				std::vector<sprx_module_info> modules;
 			};
@@ -593,6 +593,7 @@ namespace rpcs3
 				entry<u32> min_id               { this, "Excluded block range min",  200 };
 				entry<u32> max_id               { this, "Excluded block range max",  250 };
 				entry<u32> threshold            { this, "Compilation threshold",     1000 };
+				entry<bool> aot                 { this, "Ahead-of-time compilation", false };
 
 #define MACRO_PPU_INST_MAIN_EXPANDERS(MACRO) \
 	/*MACRO(HACK)*/ \
@@ -838,6 +839,9 @@ namespace rpcs3
 
 			entry<ppu_decoder_type> ppu_decoder { this, "PPU Decoder",               ppu_decoder_type::interpreter };
 			entry<spu_decoder_type> spu_decoder { this, "SPU Decoder",               spu_decoder_type::interpreter_precise };
+			entry<u32> spu_workers              { this, "SPU Worker Threads",        0 };
+			entry<u32> clock_scale              { this, "Clock Scale",               100 }; // guest clock speed in percent
+			entry<bool> clock_skip_idle         { this, "Skip idle time",            false };
 			entry<bool> hook_st_func            { this, "Hook static functions",     false };
 			entry<bool> load_liblv2             { this, "Load liblv2.sprx",          false };
 
@@ -6,6 +6,7 @@
 #include "rpcs3.h"
 #include "Gui/ConLogFrame.h"
 #include "Emu/GameInfo.h"
+#include "Emu/CPU/CPUProfiler.h"
 
 #include "Emu/Io/Keyboard.h"
 #include "Emu/Io/Null/NullKeyboardHandler.h"
@@ -56,8 +57,9 @@ bool Rpcs3App::OnInit()
 {
 	static const wxCmdLineEntryDesc desc[]
 	{
-		{ wxCMD_LINE_SWITCH, "h", "help", "Command line options:\nh (help): Help and commands\nt (test): For directly executing a (S)ELF", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+		{ wxCMD_LINE_SWITCH, "h", "help", "Command line options:\nh (help): Help and commands\nt (test): For directly executing a (S)ELF\np (profile): Sample guest threads and write folded stacks to the file", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
 		{ wxCMD_LINE_SWITCH, "t", "test", "Run in test mode on (S)ELF", wxCMD_LINE_VAL_NONE },
+		{ wxCMD_LINE_OPTION, "p", "profile", "Profile the (S)ELF, write folded stacks to the file", wxCMD_LINE_VAL_STRING },
 		{ wxCMD_LINE_PARAM, NULL, NULL, "(S)ELF", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
 		{ wxCMD_LINE_NONE }
 	};
@@ -193,6 +195,7 @@ void Rpcs3App::OnArguments(const wxCmdLineParser& parser)
 	// Usage:
 	//   rpcs3-*.exe               Initializes RPCS3
 	//   rpcs3-*.exe [(S)ELF]      Initializes RPCS3, then loads and runs the specified (S)ELF file.
+	//   rpcs3-*.exe -p=FILE [(S)ELF]  Also samples guest threads until the emulation stops, writing folded stacks to FILE.
 
 	if (parser.FoundSwitch("t"))
 	{
@@ -209,6 +212,14 @@ void Rpcs3App::OnArguments(const wxCmdLineParser& parser)
 	{
 		Emu.SetPath(fmt::ToUTF8(parser.GetParam(0)));
 		Emu.Load();
+
+		wxString profile;
+
+		if (parser.Found("p", &profile) && !Emu.IsStopped())
+		{
+			cpu_profiler_start(fmt::ToUTF8(profile));
+		}
+
 		Emu.Run();
 	}
 }